@@ -0,0 +1,234 @@
+// End-to-end throughput of the Assembler on generated programs, one scenario at a time
+// g++ -std=c++17 -O2 -pthread -Ih -o benchmark bench/benchmark.cpp
+// Each scenario is assembled within its own child process, so the peak memory of each phase belongs to that scenario alone
+// With --save-baseline the lines/sec of each scenario are stored; with --baseline any scenario which got slower than the stored one
+// by more than the tolerance is reported, and the exit status is 1
+#define ASSEMBLER_NO_MAIN
+#include "../src/main.cpp"
+#include "workload.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sys/wait.h>
+
+struct ScenarioStruct {
+    const char *name;
+    WorkloadConfig config;
+};
+
+struct PhaseResultStruct {
+    std::string name;
+    double seconds;
+    long peakMemory; // KiB
+};
+
+struct ResultStruct {
+    double seconds = 0; // Whole assembly, output included (fastest of the repetitions)
+    std::vector<PhaseResultStruct> phases;
+};
+
+std::vector<ScenarioStruct> makeScenarios(unsigned int lines)
+{
+    std::vector<ScenarioStruct> scenarios;
+    WorkloadConfig config;
+    config.lines = lines;
+    scenarios.push_back({ "mixed", config });
+    WorkloadConfig instructions = config;
+    instructions.dataShare = 0;
+    instructions.equShare = 0;
+    scenarios.push_back({ "instructions", instructions });
+    WorkloadConfig data = config;
+    data.dataShare = 0.8;
+    scenarios.push_back({ "data", data });
+    WorkloadConfig forward = config;
+    forward.forwardShare = 0.95;
+    scenarios.push_back({ "forward", forward });
+    WorkloadConfig equChains = config;
+    equChains.equShare = 0.3;
+    equChains.equChainDepth = 16;
+    scenarios.push_back({ "equ-chains", equChains });
+    WorkloadConfig sections = config;
+    sections.sections = 64;
+    scenarios.push_back({ "sections", sections });
+    return scenarios;
+}
+
+// Runs within the child process; the result is written to resultDescriptor as text
+void runScenario(const std::string &inputPath, const std::string &outputPath, unsigned int repetitions, int resultDescriptor)
+{
+    std::ostream discarded(nullptr); // Errors and warnings are not written anywhere (and nothing is traced)
+    Assembler assembler;
+    assembler.setMessageStream(discarded);
+    double bestSeconds = 0;
+    std::vector<Assembler::PhaseStruct> bestPhases;
+    for (unsigned int i = 0; i < repetitions; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (assembler.assemble(inputPath.c_str()) == false || assembler.writeBinaryOutput(outputPath.c_str()) == false)
+            _exit(1);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || seconds < bestSeconds)
+        {
+            bestSeconds = seconds;
+            bestPhases = assembler.getPhases();
+        }
+    }
+    std::ostringstream result;
+    result << std::setprecision(9) << bestSeconds;
+    for (const Assembler::PhaseStruct &phase : bestPhases)
+        result << " " << phase.name << " " << phase.seconds << " " << phase.peakMemory;
+    result << "\n";
+    std::string text = result.str();
+    if (write(resultDescriptor, text.data(), text.size()) != (ssize_t)text.size())
+        _exit(1);
+    _exit(0);
+}
+
+bool measureScenario(const std::string &inputPath, const std::string &outputPath, unsigned int repetitions, ResultStruct &result)
+{
+    int descriptors[2];
+    if (pipe(descriptors) != 0)
+        return false;
+    std::cout.flush();
+    pid_t child = fork();
+    if (child == -1)
+        return false;
+    if (child == 0)
+    {
+        close(descriptors[0]);
+        runScenario(inputPath, outputPath, repetitions, descriptors[1]);
+    }
+    close(descriptors[1]);
+    std::string text;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(descriptors[0], buffer, sizeof(buffer))) > 0)
+        text.append(buffer, count);
+    close(descriptors[0]);
+    int status;
+    if (waitpid(child, &status, 0) != child || WIFEXITED(status) == false || WEXITSTATUS(status) != 0)
+        return false;
+    std::istringstream fields(text);
+    fields >> result.seconds;
+    PhaseResultStruct phase;
+    result.phases.clear();
+    while (fields >> phase.name >> phase.seconds >> phase.peakMemory)
+        result.phases.push_back(phase);
+    return true;
+}
+
+// Baseline file: one "scenario lines/sec" pair per line
+std::map<std::string, double> readBaseline(const std::string &path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string name;
+    double linesPerSecond;
+    while (file >> name >> linesPerSecond)
+        baseline[name] = linesPerSecond;
+    return baseline;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int lines = 200000;
+    unsigned int repetitions = 3;
+    double tolerance = 0.1; // Allowed slowdown against the baseline
+    std::string baselinePath;
+    std::string saveBaselinePath;
+    std::string onlyScenario;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--lines" && i + 1 < argc)
+            lines = std::strtoul(argv[++i], nullptr, 10);
+        else if (argument == "--repetitions" && i + 1 < argc)
+            repetitions = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--tolerance" && i + 1 < argc)
+            tolerance = std::strtod(argv[++i], nullptr);
+        else if (argument == "--baseline" && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (argument == "--save-baseline" && i + 1 < argc)
+            saveBaselinePath = argv[++i];
+        else if (argument == "--scenario" && i + 1 < argc)
+            onlyScenario = argv[++i];
+        else
+        {
+            std::cout << "Unknown option: " << argument << "\n";
+            return 1;
+        }
+    }
+    std::map<std::string, double> baseline;
+    if (baselinePath.empty() == false)
+    {
+        baseline = readBaseline(baselinePath);
+        if (baseline.empty() == true)
+        {
+            std::cout << "Unable to read the baseline " << baselinePath << "!\n";
+            return 1;
+        }
+    }
+    char directoryTemplate[] = "/tmp/asm-bench-XXXXXX";
+    if (mkdtemp(directoryTemplate) == nullptr)
+    {
+        std::cout << "Unable to create a temporary directory!\n";
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+    std::string inputPath = directory + "/input.s";
+    std::string outputPath = directory + "/output.o";
+    std::ostringstream savedBaseline;
+    savedBaseline << std::fixed;
+    int status = 0;
+    std::cout << std::fixed;
+    for (const ScenarioStruct &scenario : makeScenarios(lines))
+    {
+        if (onlyScenario.empty() == false && onlyScenario != scenario.name)
+            continue;
+        std::string program = WorkloadGenerator(scenario.config).generate();
+        std::ofstream input(inputPath, std::ios::binary);
+        input << program;
+        input.close();
+        unsigned int lineCount = std::count(program.begin(), program.end(), '\n');
+        size_t programSize = program.size();
+        std::string().swap(program); // Not to be counted within the child's peak memory
+        ResultStruct result;
+        if (measureScenario(inputPath, outputPath, repetitions, result) == false)
+        {
+            std::cout << scenario.name << ": assembly failed!\n";
+            status = 1;
+            continue;
+        }
+        double linesPerSecond = lineCount / result.seconds;
+        double megabytesPerSecond = programSize / result.seconds / (1 << 20);
+        std::cout << std::left << std::setw(14) << scenario.name << std::right << std::setw(9) << lineCount << " lines "
+            << std::setprecision(0) << std::setw(11) << linesPerSecond << " lines/s "
+            << std::setprecision(2) << std::setw(8) << megabytesPerSecond << " MB/s";
+        for (const PhaseResultStruct &phase : result.phases)
+            std::cout << "  " << phase.name << " " << std::setprecision(2) << phase.seconds * 1000 << "ms/" << phase.peakMemory / 1024 << "MiB";
+        std::cout << "\n";
+        savedBaseline << scenario.name << " " << std::setprecision(0) << linesPerSecond << "\n";
+        auto stored = baseline.find(scenario.name);
+        if (stored != baseline.end() && linesPerSecond < stored->second * (1 - tolerance))
+        {
+            std::cout << "  Regression: " << std::setprecision(1) << 100 * (1 - linesPerSecond / stored->second)
+                << "% slower than the baseline (" << std::setprecision(0) << stored->second << " lines/s)!\n";
+            status = 1;
+        }
+    }
+    unlink(inputPath.c_str());
+    unlink(outputPath.c_str());
+    rmdir(directory.c_str());
+    if (saveBaselinePath.empty() == false)
+    {
+        std::ofstream file(saveBaselinePath);
+        file << savedBaseline.str();
+        if (file.good() == false)
+        {
+            std::cout << "Unable to write the baseline " << saveBaselinePath << "!\n";
+            return 1;
+        }
+    }
+    return status;
+}
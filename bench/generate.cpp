@@ -0,0 +1,43 @@
+// Prints a generated program to the standard output
+// g++ -std=c++17 -O2 -o generate bench/generate.cpp
+#include <cstdlib>
+#include <iostream>
+#include "workload.h"
+
+int main(int argc, char *argv[])
+{
+    WorkloadConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value of " << argument << "!\n";
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (argument == "--lines")
+            config.lines = std::strtoul(value, nullptr, 10);
+        else if (argument == "--sections")
+            config.sections = std::strtoul(value, nullptr, 10);
+        else if (argument == "--data")
+            config.dataShare = std::strtod(value, nullptr);
+        else if (argument == "--equ")
+            config.equShare = std::strtod(value, nullptr);
+        else if (argument == "--forward")
+            config.forwardShare = std::strtod(value, nullptr);
+        else if (argument == "--equ-depth")
+            config.equChainDepth = std::strtoul(value, nullptr, 10);
+        else if (argument == "--seed")
+            config.seed = std::strtoul(value, nullptr, 10);
+        else
+        {
+            std::cerr << "Unknown option: " << argument << "\n";
+            return 1;
+        }
+    }
+    if (config.sections == 0)
+        config.sections = 1;
+    std::cout << WorkloadGenerator(config).generate();
+    return 0;
+}
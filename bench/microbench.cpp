@@ -0,0 +1,249 @@
+// Microbenchmarks of the hot paths of the Assembler, each measured at growing sizes (1k, 10k, ... up to --max)
+// g++ -std=c++17 -O2 -pthread -Ih -o microbench bench/microbench.cpp
+// Cost per item should stay flat as the size grows; growth of the per item cost (the last column) by about 10x on each step is
+// quadratic behaviour. Each curve is a generated program which stresses one part of the Assembler, and only the phase doing
+// that work is timed (lines for classifying/decoding/looking up, symbols for patching and EQU resolution)
+#define ASSEMBLER_NO_MAIN
+#include "../src/main.cpp"
+#include "workload.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+struct CurveStruct {
+    const char *name;
+    const char *phase; // Phase which is timed
+    std::string (*makeProgram)(unsigned int size); // Program with size items of the measured kind
+};
+
+std::string name(const char *prefix, unsigned int number)
+{
+    return prefix + WorkloadGenerator::letters(number);
+}
+
+// Each label is defined and then an earlier one is looked up by a .word reference
+std::string symbolLookupProgram(unsigned int size)
+{
+    std::string program = ".section text:\n";
+    for (unsigned int i = 0; i < size; i++)
+        program += name("lab", i) + ":\n.word " + name("lab", (i * 7919u) % (i + 1)) + "\n";
+    return program;
+}
+
+// All of the references come before any of the labels, so each one is patched once the lines are processed
+std::string forwardReferenceProgram(unsigned int size)
+{
+    std::string program = ".section text:\n";
+    for (unsigned int i = 0; i < size; i++)
+        program += "jmp " + name("lab", i) + "\n";
+    for (unsigned int i = 0; i < size; i++)
+        program += name("lab", i) + ":\n";
+    return program;
+}
+
+// One chain of EQUs, each based off of the next one, so none of them can be resolved before the last one is defined
+std::string equChainProgram(unsigned int size)
+{
+    std::string program = ".section text:\nbase:\n.word " + name("eq", 0) + "\n";
+    for (unsigned int i = 0; i + 1 < size; i++)
+        program += ".equ " + name("eq", i) + ", " + name("eq", i + 1) + " + 1\n";
+    program += ".equ " + name("eq", size - 1) + ", base + 1\n";
+    return program;
+}
+
+// One .byte line with size items
+std::string byteListProgram(unsigned int size)
+{
+    std::string program = ".section text:\nlab:\n.byte 1";
+    for (unsigned int i = 1; i < size; i++)
+        program += (i % 4 == 0) ? ", lab" : ", 0x" + std::string(1, "0123456789ABCDEF"[i % 16]);
+    return program + "\n";
+}
+
+// Reservations of 64 KiB each, with an instruction in between (so the runs are not merged)
+std::string skipProgram(unsigned int size)
+{
+    std::string program = ".section bss:\n";
+    for (unsigned int i = 0; i < size; i++)
+        program += ".skip 0xFFFF\nhalt\n";
+    return program;
+}
+
+std::string operandProgram(unsigned int size, const char *operand)
+{
+    std::string program = ".section text:\nlab:\n";
+    for (unsigned int i = 0; i < size; i++)
+        program += std::string("mov ") + operand + ", %r1\n";
+    return program;
+}
+
+const std::vector<CurveStruct> CURVES = {
+    { "operand immed", "lines", [](unsigned int size) { return operandProgram(size, "$0xFF"); } },
+    { "operand regdir", "lines", [](unsigned int size) { return operandProgram(size, "%r2"); } },
+    { "operand regind", "lines", [](unsigned int size) { return operandProgram(size, "(%r2)"); } },
+    { "operand regindoff", "lines", [](unsigned int size) { return operandProgram(size, "lab(%r3)"); } },
+    { "operand mem", "lines", [](unsigned int size) { return operandProgram(size, "lab"); } },
+    { "byte list", "lines", byteListProgram },
+    { "skip", "lines", skipProgram },
+    { "symbol lookup", "lines", symbolLookupProgram },
+    { "forward references", "symbols", forwardReferenceProgram },
+    { "equ chain", "symbols", equChainProgram }
+};
+
+const double TIME_LIMIT = 10; // Seconds, for one size of one curve
+
+void printHeader()
+{
+    std::cout << "  " << std::setw(9) << "items" << std::setw(12) << "ms" << std::setw(12) << "ns/item" << std::setw(8) << "growth" << "\n";
+}
+
+// Prints one size of a curve; returns the cost per item, for the growth on the next size
+double printRow(unsigned int size, double seconds, double previousPerItem)
+{
+    double perItem = seconds * 1e9 / size;
+    std::cout << "  " << std::setw(9) << size << std::setw(12) << std::setprecision(3) << seconds * 1000 << std::setw(12)
+        << std::setprecision(1) << perItem << std::setw(8);
+    if (previousPerItem > 0)
+        std::cout << std::setprecision(2) << perItem / previousPerItem;
+    else
+        std::cout << "-";
+    std::cout << "\n";
+    std::cout.flush();
+    return perItem;
+}
+
+// Lines of each kind, classified over and over by the lexer (no Assembler involved)
+const std::vector<std::pair<const char*, const char*>> CLASSIFIED_LINES = {
+    { "label", "loop:" },
+    { "global", ".global first, second, third" },
+    { "extern", ".extern first, second" },
+    { "section", ".section text:" },
+    { "byte", ".byte 1, 0x2, lab, 4, 5, 6, 7, 8" },
+    { "word", ".word lab, 0x2, 300, other" },
+    { "skip", ".skip 0x10" },
+    { "equ", ".equ size, last - first + 4" },
+    { "noaddr", "halt" },
+    { "branch", "jmp *lab(%pc/%r7)" },
+    { "oneaddr", "push 0xFF(%r3)" },
+    { "twoaddr", "mov $lab, 8(%r4)" }
+};
+
+void classifyLines(unsigned int repetitions)
+{
+    std::cout << "Line classification (ns/line)\n";
+    for (const auto &kind : CLASSIFIED_LINES)
+    {
+        std::string_view line = kind.second;
+        unsigned int found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < repetitions; i++)
+        {
+            std::string_view current = line;
+            asm volatile("" : "+r"(current)); // Classified anew on every repetition
+            found += LineLexer(current).classify().kind != LineRecord::NONE;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (found != repetitions)
+            std::cout << "  " << kind.first << ": line is not recognized!\n";
+        std::cout << "  " << std::left << std::setw(10) << kind.first << std::right << std::setw(10) << std::setprecision(1)
+            << seconds * 1e9 / repetitions << "\n";
+    }
+}
+
+// Classification of one .byte list, as the list grows
+void classifyLists(unsigned int maxSize)
+{
+    std::cout << "List classification\n";
+    printHeader();
+    double previous = 0;
+    for (unsigned int size = 1000; size <= maxSize; size *= 10)
+    {
+        std::string line = ".byte 1";
+        for (unsigned int i = 1; i < size; i++)
+            line += ", 0x" + std::string(1, "0123456789ABCDEF"[i % 16]);
+        auto start = std::chrono::steady_clock::now();
+        bool recognized = LineLexer(line).classify().kind == LineRecord::BYTE;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        previous = printRow(size, seconds, previous);
+        if (recognized == false)
+            std::cout << "  (not recognized!)\n";
+    }
+}
+
+// Time of the curve's phase for the program, written to inputPath; negative if it could not be assembled
+double measureCurve(Assembler &assembler, const CurveStruct &curve, const std::string &inputPath)
+{
+    if (assembler.assemble(inputPath.c_str()) == false)
+        return -1;
+    for (const Assembler::PhaseStruct &phase : assembler.getPhases())
+        if (std::string(phase.name) == curve.phase)
+            return phase.seconds;
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int maxSize = 1000000;
+    std::string onlyCurve;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--max" && i + 1 < argc)
+            maxSize = std::max(1000ul, std::strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--only" && i + 1 < argc)
+            onlyCurve = argv[++i];
+        else
+        {
+            std::cout << "Unknown option: " << argument << "\n";
+            return 1;
+        }
+    }
+    char inputTemplate[] = "/tmp/asm-microbench-XXXXXX";
+    int inputDescriptor = mkstemp(inputTemplate);
+    if (inputDescriptor == -1)
+    {
+        std::cout << "Unable to create a temporary file!\n";
+        return 1;
+    }
+    close(inputDescriptor);
+    std::string inputPath = inputTemplate;
+    std::cout << std::fixed;
+    if (onlyCurve.empty() == true || onlyCurve == "classify")
+    {
+        classifyLines(1000000);
+        classifyLists(maxSize);
+    }
+    std::ostream discarded(nullptr); // Errors and warnings are not written anywhere (and nothing is traced)
+    Assembler assembler;
+    assembler.setMessageStream(discarded);
+    for (const CurveStruct &curve : CURVES)
+    {
+        if (onlyCurve.empty() == false && onlyCurve != curve.name)
+            continue;
+        std::cout << curve.name << " (" << curve.phase << " phase)\n";
+        printHeader();
+        double previous = 0;
+        for (unsigned int size = 1000; size <= maxSize; size *= 10)
+        {
+            std::ofstream input(inputPath, std::ios::binary | std::ios::trunc);
+            input << curve.makeProgram(size);
+            input.close();
+            double seconds = measureCurve(assembler, curve, inputPath);
+            if (seconds < 0)
+            {
+                std::cout << "  " << std::setw(9) << size << "  assembly failed!\n";
+                break;
+            }
+            double perItem = printRow(size, seconds, previous);
+            double growth = (previous > 0) ? perItem / previous : 1;
+            previous = perItem;
+            if (size * 10 <= maxSize && seconds * 10 * std::max(1.0, growth) > TIME_LIMIT)
+            { // Quadratic (or worse) curves would take far too long on the next size
+                std::cout << "  next size skipped: it would take more than " << (int)TIME_LIMIT << " s\n";
+                break;
+            }
+        }
+    }
+    unlink(inputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include <string>
+#include <vector>
+#include <random>
+
+// Shape of a generated program; shares are fractions of all of the lines
+struct WorkloadConfig {
+    unsigned int lines = 100000;
+    unsigned int sections = 4;
+    double dataShare = 0.2; // .byte/.word/.skip/.fill lines
+    double equShare = 0.02; // .equ lines
+    double forwardShare = 0.5; // Share of the label references which refer to a label defined further down
+    unsigned int equChainDepth = 4; // Each EQU chain starts from a label; each next EQU of the chain is based off of the previous one
+    unsigned int seed = 1;
+};
+
+// Generates a program in the assembler's dialect, with every kind of line and every addressing mode processInstruction handles
+class WorkloadGenerator {
+public:
+    WorkloadGenerator(const WorkloadConfig& _config) : config(_config), random(_config.seed) {}
+
+    std::string generate() {
+        std::string program;
+        program.reserve(config.lines * 20);
+        unsigned int labelCount = config.lines / LINES_PER_LABEL + 1;
+        program += ".global " + label(0) + ", " + label(labelCount / 2) + "\n";
+        program += ".extern exta, extb\n";
+        unsigned int line = 2;
+        unsigned int definedLabels = 0;
+        unsigned int equChains = 0;
+        unsigned int section = 0;
+        program += ".section " + sectionName(section) + ":\n";
+        line++;
+        while (line < config.lines)
+        {
+            if (line % LINES_PER_SECTION_SWITCH == 0 && config.sections > 1)
+            { // Sections are continued, not only started
+                section = (section + 1) % config.sections;
+                program += ".section " + sectionName(section) + ":\n";
+                line++;
+                continue;
+            }
+            if (line % LINES_PER_LABEL == 0 && definedLabels < labelCount)
+            {
+                program += label(definedLabels++) + ":\n";
+                line++;
+                continue;
+            }
+            double kind = uniform();
+            if (kind < config.equShare && config.equChainDepth > 0)
+            {
+                program += equChain(equChains++, definedLabels, labelCount);
+                line += config.equChainDepth;
+            }
+            else if (kind < config.equShare + config.dataShare)
+            {
+                program += dataLine(definedLabels, labelCount);
+                line++;
+            }
+            else
+            {
+                program += instruction(definedLabels, labelCount, equChains);
+                line++;
+            }
+        }
+        // Every referenced label has to be defined
+        for (; definedLabels < labelCount; definedLabels++)
+            program += label(definedLabels) + ":\n";
+        return program;
+    }
+
+    // Letters-only name suffix of a number
+    static std::string letters(unsigned int number) {
+        std::string name;
+        do
+        {
+            name += (char)('a' + number % 26);
+            number /= 26;
+        } while (number > 0);
+        return name;
+    }
+
+private:
+    static const unsigned int LINES_PER_LABEL = 8;
+    static const unsigned int LINES_PER_SECTION_SWITCH = 200;
+
+    double uniform() {
+        return (random() >> 11) * (1.0 / 9007199254740992.0); // 53 random bits
+    }
+    unsigned int below(unsigned int limit) {
+        return (limit == 0) ? 0 : random() % limit;
+    }
+
+    static std::string label(unsigned int number) {
+        return "lab" + letters(number);
+    }
+    static std::string sectionName(unsigned int number) {
+        return "sec" + letters(number);
+    }
+    static std::string equName(unsigned int chain, unsigned int link) {
+        return "eq" + letters(chain) + "x" + letters(link);
+    }
+
+    // Label which is already defined (backward reference) or which is yet to be defined (forward reference)
+    std::string referencedLabel(unsigned int definedLabels, unsigned int labelCount) {
+        bool forward = (uniform() < config.forwardShare && definedLabels < labelCount) || definedLabels == 0;
+        if (forward)
+            return label(definedLabels + below(labelCount - definedLabels));
+        return label(below(definedLabels));
+    }
+    std::string symbol(unsigned int definedLabels, unsigned int labelCount, unsigned int equChains) {
+        unsigned int choice = below(16);
+        if (choice == 0) return (below(2) == 0) ? "exta" : "extb";
+        if (choice == 1 && equChains > 0) return equName(below(equChains), below(config.equChainDepth));
+        return referencedLabel(definedLabels, labelCount);
+    }
+    std::string literal() {
+        switch (below(3))
+        { // Hexadecimal literals are made of either digits only or letters only
+        case 0: return std::to_string(below(1000));
+        case 1: return "0x" + std::to_string(below(100));
+        default: return "0x" + std::string(1, "ABCDEF"[below(6)]) + std::string(1, "abcdef"[below(6)]);
+        }
+    }
+    std::string reg() {
+        return "%r" + std::to_string(below(7));
+    }
+
+    std::string dataLine(unsigned int definedLabels, unsigned int labelCount) {
+        unsigned int kind = below(8);
+        if (kind == 0)
+            return "    .skip " + std::to_string(1 + below(16)) + "\n";
+        if (kind == 1)
+            return "    .fill " + std::to_string(1 + below(16)) + ", " + std::to_string(1 + below(2)) + ", " + std::to_string(below(256)) + "\n";
+        std::string list;
+        unsigned int count = 1 + below(6);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (i > 0) list += ", ";
+            unsigned int item = below(4);
+            if (item == 0)
+                list += referencedLabel(definedLabels, labelCount);
+            else if (item == 1)
+                list += literal();
+            else
+                list += std::to_string(below(200));
+        }
+        return ((kind < 4) ? "    .byte " : "    .word ") + list + "\n";
+    }
+
+    std::string equChain(unsigned int chain, unsigned int definedLabels, unsigned int labelCount) {
+        std::string lines = ".equ " + equName(chain, 0) + ", " + referencedLabel(definedLabels, labelCount) + " + " + std::to_string(below(100)) + "\n";
+        for (unsigned int link = 1; link < config.equChainDepth; link++)
+            lines += ".equ " + equName(chain, link) + ", " + equName(chain, link - 1) + ((below(2) == 0) ? " + " : " - ") + std::to_string(below(100)) + "\n";
+        return lines;
+    }
+
+    // Operand of a non-branch instruction; a destination operand can not be an immediate value
+    std::string operand(bool destination, unsigned int definedLabels, unsigned int labelCount, unsigned int equChains) {
+        switch (below(destination ? 8 : 10))
+        {
+        case 0: return reg(); // Register direct
+        case 1: return "(" + reg() + ")"; // Register indirect
+        case 2: return literal() + "(" + reg() + ")"; // Register indirect with a literal offset
+        case 3: return symbol(definedLabels, labelCount, equChains) + "(" + reg() + ")"; // Register indirect with a symbol offset
+        case 4: return referencedLabel(definedLabels, labelCount) + "(%pc/%r7)"; // PC relative
+        case 5: return literal(); // Memory, at a literal address
+        case 6:
+        case 7: return symbol(definedLabels, labelCount, equChains); // Memory, at a symbol
+        case 8: return "$" + literal(); // Immediate literal
+        default: return "$" + symbol(definedLabels, labelCount, equChains); // Immediate symbol
+        }
+    }
+    std::string branchOperand(unsigned int definedLabels, unsigned int labelCount, unsigned int equChains) {
+        switch (below(9))
+        {
+        case 0: return literal(); // Immediate literal
+        case 1:
+        case 2: return referencedLabel(definedLabels, labelCount); // Immediate symbol
+        case 3: return "*" + symbol(definedLabels, labelCount, equChains); // Memory
+        case 4: return "*" + reg();
+        case 5: return "*(" + reg() + ")";
+        case 6: return "*" + literal() + "(" + reg() + ")";
+        case 7: return "*" + referencedLabel(definedLabels, labelCount) + "(%pc/%r7)";
+        default: return "*" + symbol(definedLabels, labelCount, equChains) + "(" + reg() + ")";
+        }
+    }
+
+    std::string instruction(unsigned int definedLabels, unsigned int labelCount, unsigned int equChains) {
+        static const char* NOADDR[] = { "halt", "iret", "ret" };
+        static const char* BRANCH[] = { "int", "call", "jmp", "jeq", "jne", "jgt" };
+        static const char* ONEADDR[] = { "push", "pop" };
+        static const char* TWOADDR[] = { "xchg", "mov", "add", "sub", "mul", "div", "cmp", "not", "and", "or", "xor", "test", "shl", "shr" };
+        unsigned int kind = below(16);
+        if (kind == 0)
+            return std::string("    ") + NOADDR[below(3)] + "\n";
+        if (kind < 5)
+            return std::string("    ") + BRANCH[below(6)] + " " + branchOperand(definedLabels, labelCount, equChains) + "\n";
+        if (kind < 8)
+        {
+            unsigned int name = below(2);
+            return std::string("    ") + ONEADDR[name] + " " + operand(name == 1, definedLabels, labelCount, equChains) + "\n";
+        }
+        unsigned int name = below(14);
+        bool exchange = (name == 0); // xchg takes no immediate operands at all
+        return std::string("    ") + TWOADDR[name] + " " + operand(exchange, definedLabels, labelCount, equChains) + ", " +
+            operand(true, definedLabels, labelCount, equChains) + "\n";
+    }
+
+    WorkloadConfig config;
+    std::mt19937_64 random;
+};
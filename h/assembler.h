@@ -0,0 +1,259 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+#include <unordered_map>
+#include <chrono>
+
+// All of the state of assembling one source file
+// One Assembler can assemble any number of files, one after another; the tables are only cleared in between, so their capacity is reused
+class Assembler {
+public:
+    // Counters of what was done; kept for the whole assembly, and for each of its phases
+    struct StatsStruct {
+        unsigned long lines[LineRecord::TWOADDR_INSTRUCTION + 1] = {}; // By LineRecord::Kind (NONE for the empty and unrecognized lines)
+        unsigned long lexerRuns = 0; // Lines classified by LineLexer (lines which were cached by incremental assembly are not)
+        unsigned long regexSearches = 0;
+        unsigned long symbolLookups = 0;
+        unsigned long symbolLookupProbes = 0;
+        unsigned long patchedForwardReferences = 0;
+        unsigned long addedRelocations = 0;
+        unsigned long erasedRelocations = 0;
+        unsigned long emittedBytes = 0;
+        // Time the pipeline stages (see setPipelined) spent waiting on each other, in seconds; 0 unless pipelined
+        double readerStallSeconds = 0;
+        double parserStallSeconds = 0;
+        double processingStallSeconds = 0;
+        StatsStruct since(const StatsStruct &start) const;
+    };
+    struct PhaseStruct {
+        const char *name;
+        double seconds;
+        double cpuSeconds; // Of the assembling thread, and of the threads it started for the phase (parsing, pipeline stages)
+        long peakMemory; // Peak resident set size of the whole process by the end of the phase (not only this assembly's), in KiB
+        StatsStruct stats; // Done during the phase
+        PhaseStruct(const char *_name, double _seconds, double _cpuSeconds, long _peakMemory, const StatsStruct &_stats) :
+            name(_name), seconds(_seconds), cpuSeconds(_cpuSeconds), peakMemory(_peakMemory), stats(_stats) {}
+    };
+
+    Assembler();
+
+    // When set, every line is also classified with the reference regexes and any disagreement with LineLexer is reported
+    void setValidateLexer(bool _validateLexer) {
+        validateLexer = _validateLexer;
+    }
+    bool getValidateLexer() {
+        return validateLexer;
+    }
+    // With more than 1 thread, lines of a file are parsed on that many threads, in chunks, before they are processed in order
+    void setParseThreads(unsigned int _parseThreads) {
+        parseThreads = _parseThreads;
+    }
+    // When set, reading the lines, parsing them and processing them are done on three threads at the same time
+    void setPipelined(bool _pipelined) {
+        pipelined = _pipelined;
+    }
+    // When set, what each block of lines did (emitted bytes, relocations, forward references, symbols) is kept from one assembly to the
+    // next; a block which is unchanged, and starts from the same state as before, is replayed instead of being parsed and encoded again
+    void setIncremental(bool _incremental) {
+        incremental = _incremental;
+    }
+    // All of the messages (errors, warnings and, when tracing, what was found on each line) go to this stream; std::cout by default
+    void setMessageStream(std::ostream &stream) {
+        diagnostics.setStream(stream);
+    }
+    // Errors and warnings by default; at Diagnostics::TRACE every line being processed is described as well
+    void setMessageLevel(Diagnostics::Level level) {
+        diagnostics.setLevel(level);
+    }
+
+    // Processes all of the lines and resolves all of the symbols; returns false if the file could not be read
+    // Errors and warnings are written out once the symbols are resolved
+    bool assemble(const char *inputPath);
+
+    bool writeTextOutput(const char *path, bool denseLayout);
+    bool writeBinaryOutput(const char *path);
+
+    // Errors reported by the last assembly
+    unsigned int getErrorCount() {
+        return diagnostics.getErrorCount();
+    }
+
+    // Lines of the last incremental assembly, and how many of them had to be parsed and encoded (were not replayed)
+    unsigned int getLineCount() {
+        return lineCount;
+    }
+    unsigned int getEncodedLineCount() {
+        return encodedLineCount;
+    }
+
+    // Phases of the last assembly (read, lines, symbols), followed by the output phase once the output is written
+    const std::vector<PhaseStruct>& getPhases() {
+        return phases;
+    }
+    StatsStruct getStats();
+    // Phases, counters and sections of the last assembly, as one line of JSON
+    void writeStatsJson(std::ostream &stream, const std::string &inputPath);
+
+private:
+    static const unsigned int INITIAL_SECTION_CAPACITY = 16;
+    static const unsigned int INITIAL_SYMBOL_CAPACITY = 1024;
+    static const unsigned int CHUNKS_PER_PARSE_THREAD = 4; // In one window (see processLinesInParallel)
+    static const unsigned int PARSE_CHUNK_SIZE = 1 << 16; // Bytes
+    static const unsigned int PIPELINE_BATCH_SIZE = 256; // Lines
+    static const unsigned int PIPELINE_QUEUE_SIZE = 64; // Batches
+    static const unsigned int BLOCK_BOUNDARY_LINES = 64; // A block ends after about one line in this many, decided by the line's text
+    static const unsigned int MAX_BLOCK_LINES = 1024;
+    static const unsigned int TEXT_DUMP_WINDOW = 4096; // Bytes; a multiple of 16, so the rows of the dense layout are never split
+
+    // Everything about a line which does not depend on any other line, so lines can be parsed in any order (or at the same time)
+    struct ParsedLine {
+        LineRecord record;
+        bool lexerMismatch = false;
+        Operand operands[2]; // Decoded operands of an instruction
+        unsigned int regexSearches = 0; // Done while parsing the line
+    };
+    // Lines passed from one pipeline stage to the next; parsed is filled in by the parsing stage
+    struct PipelineBatch {
+        std::vector<std::string_view> lines;
+        std::vector<ParsedLine> parsed;
+        bool last = false; // No more lines after this batch
+    };
+    // Chunks of lines parsed at the same time, and their parsed lines (by chunk); the vectors are reused from one window to the next
+    struct ParseWindow {
+        std::vector<std::string_view> chunks;
+        std::vector<std::vector<std::string_view>> lines;
+        std::vector<std::vector<ParsedLine>> parsed;
+    };
+    // Symbol which was already in the symbol table when a block first used it, as it was then and as the block left it
+    struct BlockSymbolStruct {
+        std::string name;
+        SymbolTableEntry before;
+        SymbolTableEntry after;
+        bool valueSet = false; // By a label or an EQU within the block; otherwise the symbol keeps the value it has when the block is replayed
+        BlockSymbolStruct(const std::string &_name, const SymbolTableEntry &_before) : name(_name), before(_before), after(_before) {}
+    };
+    // Word, byte or symbol value which a block worked out from the value of a symbol, or from the location counter at its start
+    struct ValueUseStruct {
+        enum Target {
+            WORD,
+            BYTE,
+            SYMBOL
+        };
+        Target target;
+        unsigned int position; // Offset from the start of the block (WORD, BYTE) or symbol number (SYMBOL)
+        unsigned int source; // Number of the symbol; 0 for the location counter at the start of the block
+        int sign;
+        int value; // Of the source, when the block was processed
+        ValueUseStruct(Target _target, unsigned int _position, unsigned int _source, int _sign, int _value) :
+            target(_target), position(_position), source(_source), sign(_sign), value(_value) {}
+    };
+    // Everything a block of lines (within one section, without any .section directive) did when it was processed, and the state it
+    // was processed in; offsets are from the start of the block, so it can be replayed wherever it starts within the same section, as
+    // long as the symbols it uses are of the same kind, section and scope as back then (see replayBlock)
+    struct CachedBlock {
+        unsigned int generation = 0; // Last assembly in which the block was used
+        unsigned int lineCount = 0;
+        unsigned long lines[LineRecord::TWOADDR_INSTRUCTION + 1] = {}; // By LineRecord::Kind
+        int sectionNumber = -1;
+        unsigned int locationCounter = 0; // At the start of the block, when it was processed
+        unsigned int symbolCount = 0; // At the start of the block; numbers of the added symbols follow from it
+        std::vector<BlockSymbolStruct> usedSymbols;
+        std::vector<std::pair<std::string, SymbolTableEntry>> addedSymbols;
+        Section::Piece contents;
+        std::vector<ForwardReferenceStruct> forwardReferences;
+        std::vector<EquTableEntry> equSymbols;
+        std::vector<ValueUseStruct> valueUses;
+        unsigned int size = 0; // Bytes
+    };
+
+    void reset();
+    void startPhase();
+    void endPhase(const char *name);
+    void countParsedLine(const ParsedLine &parsed) {
+        stats.lexerRuns++;
+        stats.regexSearches += parsed.regexSearches;
+    }
+
+    std::vector<SymbolTableEntry>::iterator findSymbol(std::string_view name);
+    void addSymbol(SymbolTableEntry symbol);
+    Section *getSection(unsigned int sectionNumber);
+
+    void processLinesInParallel(SourceFile &assemblyFile);
+    void processLinesPipelined(SourceFile &assemblyFile);
+    void processLinesIncrementally(SourceFile &assemblyFile);
+    void processBlock(const std::vector<std::string_view> &lines);
+    bool replayBlock(CachedBlock &block);
+    void recordBlock(const std::vector<std::string_view> &lines, CachedBlock &block);
+    void noteUsedSymbol(SymbolTableEntry &symbol);
+    void noteValueUse(ValueUseStruct::Target target, unsigned int position, unsigned int source, int sign);
+    void noteValueSet(SymbolTableEntry &symbol);
+    void processLine(std::string_view line);
+    static void parseLine(std::string_view line, bool validateLexer, ParsedLine &parsed);
+    void processParsedLine(std::string_view line, const ParsedLine &parsed);
+    void processLabelDefinition(std::string_view label);
+    void processGlobal(std::string_view symbol, bool isExtern);
+    void processSection(std::string_view section);
+    void processMemoryAllocation(unsigned int option, std::string_view items);
+    void processInstruction(const LineRecord &record, const Operand *operands);
+    typedef void (Assembler::*OperandEncoder)(const Operand &operand, short data);
+    static const OperandEncoder OPERAND_ENCODERS[3][ADDRESSING_COUNT][2]; // Branch, one address and two address instructions
+    template <LineRecord::Kind instructionKind, Operand::Mode mode, bool isSymbol>
+    void encodeOperand(const Operand &operand, short data);
+    void emitSymbolValue(std::string_view symbolName);
+    void emitSymbolOffset(std::string_view symbolName, unsigned int registerNumber);
+    void traceOperand(const Operand &operand, bool isBranch);
+    void processEqu(std::string_view symbolName, std::string_view expression);
+
+    void patchForwardReferences(bool equSymbols);
+    void processNonEquForwardReferences();
+    std::string describeEquCycle(unsigned int equPosition, const std::vector<unsigned int> &pending, std::vector<bool> &reported);
+    void processEquValues();
+    void processEquForwardReferences();
+
+    int currentSectionNumber = -1; // -1 for a section number means no section is currently being processed
+    // Section which is currently being processed (nullptr if there is none); emitted bytes and relocation data go straight into it
+    Section *currentSection = nullptr;
+    // Location counter is being reset back to 0, for each new section
+    unsigned int locationCounter = 0;
+    // All of the sections (contents, relocation table, location counter), in the order of their first appearance
+    // One section can be split into multiple .section directives; therefore, when continuing one section, location counter must not be reset back to 0
+    // Location counter of a section is saved within its Section object while some other section is being processed
+    std::vector<Section> sections;
+    // Section number -> position of the section within sections (-1 if the number does not belong to a section)
+    std::vector<int> sectionIndexes;
+    // Symbol table
+    std::vector<SymbolTableEntry> symbolTable;
+    // EQU Symbol table
+    std::vector<EquTableEntry> equSymbolTable;
+    // Position of each EQU symbol within the EQU symbol table, by symbol number (-1 for non-EQU symbols); filled in once all of the lines are processed
+    std::vector<int> equSymbolIndex;
+    // Uses of symbols which were not yet defined when referenced, for all symbols and all sections
+    std::vector<ForwardReferenceStruct> forwardReferences;
+    bool validateLexer = false;
+    unsigned int parseThreads = 1;
+    bool pipelined = false;
+    bool incremental = false;
+    // Processed blocks, by the text of the block; kept from one assembly to the next (not cleared by reset)
+    // The same text can be processed in different states (a block which is repeated within the file), so each of them is kept
+    std::unordered_map<std::string, std::vector<CachedBlock>> blockCache;
+    std::string cacheKey; // Reused for the lookups, so they do not allocate
+    unsigned int cacheGeneration = 0;
+    CachedBlock *recordedBlock = nullptr; // Block being processed for the cache; findSymbol notes the symbols it uses
+    std::vector<unsigned int> symbolUseMarks; // Symbol number - 1 -> last block (by blockSerial) which noted the symbol
+    unsigned int blockSerial = 0;
+    unsigned int lineCount = 0;
+    unsigned int encodedLineCount = 0;
+    std::vector<PhaseStruct> phases;
+    std::chrono::steady_clock::time_point phaseStart;
+    double phaseStartCpu = 0;
+    double helperCpuSeconds = 0; // Of the threads started by this Assembler, added once they are done
+    StatsStruct phaseStartStats;
+    StatsStruct stats; // Counters which are not kept by the tables themselves (see getStats)
+    Diagnostics diagnostics;
+    unsigned int currentLine = 0; // Number of the line being processed
+    // Names of all symbols and sections
+    NameArena symbolNames;
+    // Name ID -> position of the symbol within the symbol table (-1 if there is no such symbol); symbols are only ever added through addSymbol, which keeps the two in sync
+    std::vector<int> symbolTableIndex;
+};
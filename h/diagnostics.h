@@ -0,0 +1,99 @@
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Messages of one assembly, by level
+// Errors and warnings are collected, together with the number of the line they are about, and written out all at once by flush;
+// trace messages (what was found on each line, and how it was encoded) go straight to the stream, and only at the TRACE level
+// Trace sites are written as TRACE(stream expression): with NDEBUG defined they compile to nothing, otherwise they cost one branch
+// for as long as tracing is not enabled
+class Diagnostics {
+public:
+    enum Level {
+        ERROR,
+        WARNING,
+        TRACE
+    };
+
+    void setStream(std::ostream& _stream) {
+        stream = &_stream;
+    }
+    std::ostream& getStream() {
+        return *stream;
+    }
+    void setLevel(Level _level) {
+        level = _level;
+    }
+    bool tracing() const {
+        return level == TRACE;
+    }
+
+    // Line which is being processed (1 for the first line); 0 once the lines are done, for the messages about the whole file
+    void setLine(unsigned int _line) {
+        line = _line;
+    }
+
+    void error(const std::string& message) {
+        report(ERROR, message);
+    }
+    void warning(const std::string& message) {
+        report(WARNING, message);
+    }
+
+    unsigned int getErrorCount() const {
+        return errorCount;
+    }
+    // Errors and warnings reported so far, including the ones which are not kept at the current level
+    unsigned int getReportCount() const {
+        return reportCount;
+    }
+
+    // Writes out the collected errors and warnings, in the order in which they were reported
+    void flush() {
+        for (const MessageStruct& message : messages)
+        {
+            *stream << ((message.level == ERROR) ? "Error" : "Warning");
+            if (message.line != 0)
+                *stream << " at line " << message.line;
+            *stream << ": " << message.text << "\n";
+        }
+        messages.clear();
+    }
+
+    // Forgets the messages which were not flushed, and the error count
+    void clear() {
+        messages.clear();
+        errorCount = 0;
+        reportCount = 0;
+        line = 0;
+    }
+
+private:
+    struct MessageStruct {
+        Level level;
+        unsigned int line;
+        std::string text;
+        MessageStruct(Level _level, unsigned int _line, const std::string& _text) : level(_level), line(_line), text(_text) {}
+    };
+
+    void report(Level messageLevel, const std::string& text) {
+        if (messageLevel == ERROR)
+            errorCount++;
+        reportCount++;
+        if (messageLevel <= level)
+            messages.push_back(MessageStruct(messageLevel, line, text));
+    }
+
+    std::ostream* stream = nullptr;
+    Level level = WARNING;
+    unsigned int line = 0;
+    unsigned int errorCount = 0;
+    unsigned int reportCount = 0;
+    std::vector<MessageStruct> messages;
+};
+
+#ifdef NDEBUG
+#define TRACE(message) do {} while (false)
+#else
+#define TRACE(message) do { if (diagnostics.tracing() == true) diagnostics.getStream() << message; } while (false)
+#endif
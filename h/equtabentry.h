@@ -1,6 +1,5 @@
 #include <string>
 #include <vector>
-#include <list>
 
 struct ClassificationIndexStruct {
     unsigned int sectionNumber;
@@ -8,10 +7,11 @@ struct ClassificationIndexStruct {
     ClassificationIndexStruct(unsigned int _sectionNumber, int _classificationIndex) : sectionNumber(_sectionNumber), classificationIndex(_classificationIndex) {}
 };
 
-struct HelpStruct {
-    unsigned int locationCounter;
-    unsigned int sectionNumber;
-    HelpStruct(unsigned int _locationCounter, unsigned int _sectionNumber) : locationCounter(_locationCounter), sectionNumber(_sectionNumber) {}
+// EQU symbol (its position within the EQU symbol table) whose expression contains some other EQU symbol, with the given sign
+struct EquDependentStruct {
+    unsigned int equPosition;
+    char sign;
+    EquDependentStruct(unsigned int _equPosition, char _sign) : equPosition(_equPosition), sign(_sign) {}
 };
 
 class EquTableEntry {
@@ -20,19 +20,13 @@ public:
         return symbolNumber;
     }
 
-    std::vector<char> getSymbolSigns() {
+    const std::vector<char>& getSymbolSigns() {
         return symbolSigns;
     }
-    void removeSymbolSign(int position) {
-        symbolSigns.erase(symbolSigns.begin() + position);
-    }
 
-    std::vector<unsigned int> getSymbolDependencies() {
+    const std::vector<unsigned int>& getSymbolDependencies() {
         return symbolDependencies;
     }
-    void removeSymbolDependency(int position) {
-        symbolDependencies.erase(symbolDependencies.begin() + position);
-    }
 
     std::vector<ClassificationIndexStruct> getClassIndexTable() {
         return classificationIndexTable;
@@ -52,13 +46,6 @@ public:
             classificationIndexTable.push_back(ClassificationIndexStruct(sectionNumber, value));
     }
 
-    std::list<HelpStruct> getForwardReferences() {
-        return forwardsReferences;
-    }
-    void addForwardReference(HelpStruct forwardRef) {
-        forwardsReferences.insert(forwardsReferences.end(), forwardRef);
-    }
-
     bool isExpressionValid() {
         bool entryNot0 = false;
         for (int i = 0; i < classificationIndexTable.size(); i++)
@@ -82,6 +69,14 @@ public:
         return -1;
     }
 
+    // Result of entryNotZero, kept once the symbol is resolved (all of its dependencies are accounted for in the classification index table)
+    void setResolved() {
+        entryNot0 = entryNotZero();
+    }
+    int getEntryNot0() {
+        return entryNot0;
+    }
+
     EquTableEntry(unsigned int _symbolNumber, std::vector<char>& _symbolSigns, std::vector<unsigned int> _symbolDependencies, 
         std::vector<ClassificationIndexStruct> _classificationIndexTable) : symbolNumber(_symbolNumber), symbolSigns(_symbolSigns), symbolDependencies(_symbolDependencies), classificationIndexTable(_classificationIndexTable) {}
 
@@ -90,5 +85,5 @@ private:
     std::vector<char> symbolSigns;
     std::vector<unsigned int> symbolDependencies;
     std::vector<ClassificationIndexStruct> classificationIndexTable;
-    std::list<HelpStruct> forwardsReferences;
+    int entryNot0 = -1;
 };
\ No newline at end of file
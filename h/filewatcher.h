@@ -0,0 +1,65 @@
+#include <string>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+// Waits for a file to be saved (inotify)
+// The file's directory is watched rather than the file itself, since editors often save by writing a new file and renaming it over the old one
+class FileWatcher {
+public:
+    FileWatcher() {}
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        size_t slash = path.find_last_of('/');
+        std::string directory = (slash == std::string::npos) ? "." : ((slash == 0) ? "/" : path.substr(0, slash));
+        fileName = (slash == std::string::npos) ? path : path.substr(slash + 1);
+        fileDescriptor = inotify_init1(IN_CLOEXEC);
+        if (fileDescriptor == -1) return false;
+        if (inotify_add_watch(fileDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (fileDescriptor != -1)
+            ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+
+    // Blocks until the file is saved; returns false if the file can not be watched anymore
+    bool waitForChange() {
+        alignas(inotify_event) char buffer[4096];
+        while (true)
+        {
+            ssize_t length = read(fileDescriptor, buffer, sizeof(buffer));
+            if (length < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bool changed = false;
+            for (char* position = buffer; position < buffer + length; )
+            {
+                inotify_event* event = reinterpret_cast<inotify_event*>(position);
+                if ((event->mask & IN_IGNORED) != 0) return false; // Directory itself is gone
+                if (event->len > 0 && fileName == event->name)
+                    changed = true;
+                position += sizeof(inotify_event) + event->len;
+            }
+            if (changed == true) return true;
+        }
+    }
+
+private:
+    int fileDescriptor = -1;
+    std::string fileName;
+};
@@ -0,0 +1,385 @@
+#include <string_view>
+
+// Result of classifying one source line; all of the views point into the classified line
+struct LineRecord {
+    enum Kind {
+        NONE, // Empty line, or a line which is neither a directive nor an instruction
+        LABEL,
+        GLOBAL,
+        EXTERN,
+        SECTION,
+        BYTE,
+        WORD,
+        SKIP,
+        FILL,
+        EQU,
+        NOADDR_INSTRUCTION,
+        BRANCH_INSTRUCTION,
+        ONEADDR_INSTRUCTION,
+        TWOADDR_INSTRUCTION
+    };
+    Kind kind = NONE;
+    std::string_view name; // Label name, section name, EQU symbol name or instruction name
+    std::string_view body; // List of symbols/literals, .skip literal, .fill literals or EQU expression
+    int operationCode = -1; // Of an instruction (the kind of instruction tells how its operands are encoded)
+    std::string_view operands[2];
+    unsigned int numOfOperands = 0;
+
+    bool operator==(const LineRecord& other) const {
+        return kind == other.kind && name == other.name && body == other.body && operationCode == other.operationCode &&
+            numOfOperands == other.numOfOperands && operands[0] == other.operands[0] && operands[1] == other.operands[1];
+    }
+    bool operator!=(const LineRecord& other) const {
+        return !(*this == other);
+    }
+};
+
+// Hand-written replacement for the regex cascade in regexes.h: a line is scanned once, left to right, without any allocation,
+// and the first significant character (or keyword) decides which directive/instruction the rest of the line is checked against
+// Accepted language is the same as the one of the regexes, except that lists and expressions must be proper comma/sign separated
+// sequences (the regexes also accept some degenerate forms, such as doubled commas, and then drop parts of them)
+class LineLexer {
+public:
+    LineLexer(std::string_view _line) : line(_line), position(0) {}
+
+    LineRecord classify() {
+        LineRecord record;
+        scanLine(record);
+        if (record.kind == LineRecord::NONE)
+            return LineRecord(); // Views of a partially scanned line are not kept
+        return record;
+    }
+
+private:
+    void scanLine(LineRecord& record) {
+        while (position < line.size() && isSpace(line[position])) position++;
+        if (position == line.size()) return;
+        if (line[position] == '.')
+        { // Directive
+            position++;
+            std::string_view keyword;
+            if (scanIdentifier(keyword) == false || skipBlanks() == false) return;
+            if (keyword == "global" || keyword == "extern")
+            {
+                if (scanList(false, record.body) && atEnd())
+                    record.kind = (keyword == "global") ? LineRecord::GLOBAL : LineRecord::EXTERN;
+            }
+            else if (keyword == "section")
+            {
+                if (scanIdentifier(record.name) && position < line.size() && line[position] == ':')
+                {
+                    position++;
+                    if (atEnd()) record.kind = LineRecord::SECTION;
+                }
+            }
+            else if (keyword == "byte" || keyword == "word")
+            {
+                if (scanList(true, record.body) && atEnd())
+                    record.kind = (keyword == "byte") ? LineRecord::BYTE : LineRecord::WORD;
+            }
+            else if (keyword == "skip")
+            {
+                if (scanLiteral(record.body) && atEnd())
+                    record.kind = LineRecord::SKIP;
+            }
+            else if (keyword == "fill")
+            { // count[, size[, value]]
+                if (scanLiterals(3, record.body) && atEnd())
+                    record.kind = LineRecord::FILL;
+            }
+            else if (keyword == "equ")
+            {
+                if (scanIdentifier(record.name) && skipSeparator(',') && scanExpression(record.body) && atEnd())
+                    record.kind = LineRecord::EQU;
+            }
+            return;
+        }
+        // Label or instruction
+        std::string_view identifier;
+        if (scanIdentifier(identifier) == false) return;
+        if (position < line.size() && line[position] == ':')
+        { // Label - the rest of the line is not processed
+            record.kind = LineRecord::LABEL;
+            record.name = identifier;
+            return;
+        }
+        int operationCode = instructionOperationCode(identifier);
+        LineRecord::Kind kind = instructionKind(operationCode);
+        if (kind == LineRecord::NONE) return;
+        if (kind == LineRecord::NOADDR_INSTRUCTION)
+        {
+            if (atEnd() == false) return;
+        }
+        else
+        {
+            if (skipBlanks() == false || scanOperand(kind == LineRecord::BRANCH_INSTRUCTION, record.operands[0]) == false) return;
+            record.numOfOperands = 1;
+            if (kind == LineRecord::TWOADDR_INSTRUCTION)
+            {
+                if (skipSeparator(',') == false || scanOperand(false, record.operands[1]) == false) return;
+                record.numOfOperands = 2;
+            }
+            if (atEnd() == false) return;
+        }
+        record.kind = kind;
+        record.name = identifier;
+        record.operationCode = operationCode;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t';
+    }
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+    static bool isLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+    static bool isHexLetter(char c) {
+        return (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+    static bool isWordChar(char c) {
+        return isLetter(c) || isDigit(c) || c == '_';
+    }
+
+    static LineRecord::Kind instructionKind(int operationCode) {
+        constexpr int LAST_NOADDR = instructionOperationCode("ret");
+        constexpr int LAST_BRANCH = instructionOperationCode("jgt");
+        constexpr int LAST_ONEADDR = instructionOperationCode("pop");
+        if (operationCode == -1) return LineRecord::NONE;
+        if (operationCode <= LAST_NOADDR) return LineRecord::NOADDR_INSTRUCTION;
+        if (operationCode <= LAST_BRANCH) return LineRecord::BRANCH_INSTRUCTION;
+        if (operationCode <= LAST_ONEADDR) return LineRecord::ONEADDR_INSTRUCTION;
+        return LineRecord::TWOADDR_INSTRUCTION;
+    }
+
+    bool skipBlanks() { // Returns true if at least one blank has been skipped
+        size_t start = position;
+        while (position < line.size() && isBlank(line[position])) position++;
+        return position != start;
+    }
+    bool skipSeparator(char separator) {
+        skipBlanks();
+        if (position == line.size() || line[position] != separator) return false;
+        position++;
+        skipBlanks();
+        return true;
+    }
+    bool atEnd() {
+        skipBlanks();
+        return position == line.size();
+    }
+
+    bool scanIdentifier(std::string_view& identifier) { // [a-zA-Z]\w*
+        size_t start = position;
+        if (position == line.size() || isLetter(line[position]) == false) return false;
+        while (position < line.size() && isWordChar(line[position])) position++;
+        identifier = line.substr(start, position - start);
+        return true;
+    }
+    bool scanLiteral(std::string_view& literal) { // [1-9][0-9]*|0x[0-9]+|0x[a-fA-F]+|0
+        size_t start = position;
+        if (position == line.size() || isDigit(line[position]) == false) return false;
+        if (line[position] == '0' && position + 1 < line.size() && line[position + 1] == 'x')
+        { // Hexadecimal literal - either only digits or only letters
+            position += 2;
+            size_t digitsStart = position;
+            if (position < line.size() && isDigit(line[position]))
+                while (position < line.size() && isDigit(line[position])) position++;
+            else
+                while (position < line.size() && isHexLetter(line[position])) position++;
+            if (position == digitsStart) return false;
+        }
+        else if (line[position] == '0')
+            position++;
+        else
+            while (position < line.size() && isDigit(line[position])) position++;
+        // A literal can not be directly followed by another word character
+        if (position < line.size() && isWordChar(line[position])) return false;
+        literal = line.substr(start, position - start);
+        return true;
+    }
+    bool scanSymbolOrLiteral(bool allowLiterals, std::string_view& item) {
+        if (position < line.size() && isDigit(line[position]))
+            return allowLiterals && scanLiteral(item);
+        return scanIdentifier(item);
+    }
+    bool scanList(bool allowLiterals, std::string_view& list) { // item([ \t]*,[ \t]*item)*
+        size_t start = position;
+        std::string_view item;
+        if (scanSymbolOrLiteral(allowLiterals, item) == false) return false;
+        size_t end = position;
+        while (true)
+        {
+            skipBlanks();
+            if (position == line.size() || line[position] != ',') break;
+            position++;
+            skipBlanks();
+            if (scanSymbolOrLiteral(allowLiterals, item) == false) return false;
+            end = position;
+        }
+        list = line.substr(start, end - start);
+        return true;
+    }
+    bool scanLiterals(unsigned int maxCount, std::string_view& list) { // 1 to maxCount comma separated literals
+        size_t start = position;
+        std::string_view literal;
+        if (scanLiteral(literal) == false) return false;
+        size_t end = position;
+        for (unsigned int count = 1; count < maxCount; count++)
+        {
+            skipBlanks();
+            if (position == line.size() || line[position] != ',') break;
+            position++;
+            skipBlanks();
+            if (scanLiteral(literal) == false) return false;
+            end = position;
+        }
+        list = line.substr(start, end - start);
+        return true;
+    }
+    bool scanExpression(std::string_view& expression) { // term([ \t]*[+-][ \t]*term)*
+        size_t start = position;
+        std::string_view term;
+        if (scanSymbolOrLiteral(true, term) == false) return false;
+        size_t end = position;
+        while (true)
+        {
+            skipBlanks();
+            if (position == line.size() || (line[position] != '+' && line[position] != '-')) break;
+            position++;
+            skipBlanks();
+            if (scanSymbolOrLiteral(true, term) == false) return false;
+            end = position;
+        }
+        expression = line.substr(start, end - start);
+        return true;
+    }
+    bool scanRegister(bool allowPc) { // %r[0-7] or, if allowed, %pc/%r7
+        if (line.substr(position, 2) == "%r" && position + 2 < line.size() && line[position + 2] >= '0' && line[position + 2] <= '7')
+        {
+            position += 3;
+            return true;
+        }
+        if (allowPc && line.substr(position, 7) == "%pc/%r7")
+        {
+            position += 7;
+            return true;
+        }
+        return false;
+    }
+    bool scanOperand(bool isBranch, std::string_view& operand) {
+        // Branch instructions: *?literal, *?symbol, *%rN, *(%rN), *literal(%rN), *symbol(%rN|%pc/%r7)
+        // Other instructions: $?literal, $?symbol, %rN, (%rN), literal(%rN), symbol(%rN|%pc/%r7)
+        size_t start = position;
+        bool hasPrefix = false;
+        if (position < line.size() && line[position] == (isBranch ? '*' : '$'))
+        {
+            hasPrefix = true;
+            position++;
+        }
+        // Register based addressing requires '*' for branch instructions and does not allow '$' for the others
+        bool registerAllowed = (hasPrefix == isBranch);
+        if (position == line.size()) return false;
+        char c = line[position];
+        if (c == '%')
+        { // Register direct
+            if (registerAllowed == false || scanRegister(false) == false) return false;
+        }
+        else if (c == '(')
+        { // Register indirect
+            position++;
+            if (registerAllowed == false || scanRegister(false) == false || position == line.size() || line[position] != ')') return false;
+            position++;
+        }
+        else
+        {
+            bool isLiteral = isDigit(c);
+            std::string_view value;
+            if (scanSymbolOrLiteral(true, value) == false) return false;
+            if (position < line.size() && line[position] == '(')
+            { // Register indirect with an offset
+                position++;
+                if (registerAllowed == false || scanRegister(isLiteral == false) == false || position == line.size() || line[position] != ')') return false;
+                position++;
+            }
+        }
+        operand = line.substr(start, position - start);
+        return true;
+    }
+
+    std::string_view line;
+    size_t position;
+};
+
+// Items of a list accepted by LineLexer (symbols and literals separated by commas and blanks), taken one at a time, in place
+class ListScanner {
+public:
+    ListScanner(std::string_view _list) : list(_list), position(0) {}
+
+    // Returns false once there are no more items
+    bool next(std::string_view& item) {
+        while (position < list.size() && isSeparator(list[position])) position++;
+        if (position == list.size()) return false;
+        size_t start = position;
+        while (position < list.size() && isSeparator(list[position]) == false) position++;
+        item = list.substr(start, position - start);
+        return true;
+    }
+
+private:
+    static bool isSeparator(char c) {
+        return c == ',' || c == ' ' || c == '\t';
+    }
+
+    std::string_view list;
+    size_t position;
+};
+
+// Value of a literal accepted by LineLexer ([1-9][0-9]*|0x[0-9]+|0x[a-fA-F]+|0); wraps around if it does not fit
+inline unsigned long literalValue(std::string_view literal) {
+    unsigned long value = 0;
+    if (literal.size() > 2 && literal[1] == 'x')
+    {
+        for (size_t i = 2; i < literal.size(); i++)
+            value = value * 16 + ((literal[i] <= '9') ? literal[i] - '0' : (literal[i] | 0x20) - 'a' + 10);
+        return value;
+    }
+    for (char digit : literal)
+        value = value * 10 + (digit - '0');
+    return value;
+}
+
+// Terms of an EQU expression accepted by LineLexer (symbols and literals separated by signs and blanks), taken one at a time, in place,
+// together with their signs (the first term's sign is '+')
+class ExpressionScanner {
+public:
+    ExpressionScanner(std::string_view _expression) : expression(_expression), position(0) {}
+
+    // Returns false once there are no more terms
+    bool next(char& sign, std::string_view& term) {
+        sign = '+';
+        while (position < expression.size() && isSeparator(expression[position]))
+        {
+            if (expression[position] == '-') sign = '-';
+            else if (expression[position] == '+') sign = '+';
+            position++;
+        }
+        if (position == expression.size()) return false;
+        size_t start = position;
+        while (position < expression.size() && isSeparator(expression[position]) == false) position++;
+        term = expression.substr(start, position - start);
+        return true;
+    }
+
+private:
+    static bool isSeparator(char c) {
+        return c == '+' || c == '-' || c == ' ' || c == '\t';
+    }
+
+    std::string_view expression;
+    size_t position;
+};
@@ -0,0 +1,102 @@
+#include <string_view>
+#include <vector>
+#include <functional>
+
+// All symbol and section names are stored once, back to back, within a single buffer
+// A name is referred to by its ID (IDs are handed out as 0, 1, 2, ... in the order in which the names are interned)
+class NameArena {
+public:
+    static const int NOT_FOUND = -1;
+
+    // Returns the ID of the name, interning the name first if it is not in the arena yet
+    unsigned int intern(std::string_view name) {
+        size_t hash = std::hash<std::string_view>()(name);
+        int id = find(name, hash);
+        if (id != NOT_FOUND) return id;
+        if ((names.size() + 1) * 2 > slots.size())
+            grow();
+        names.push_back(NameStruct(storage.size(), name.size(), hash));
+        storage.insert(storage.end(), name.begin(), name.end());
+        insertIntoSlots(names.size() - 1);
+        return names.size() - 1;
+    }
+
+    int find(std::string_view name) const {
+        return find(name, std::hash<std::string_view>()(name));
+    }
+
+    std::string_view getName(unsigned int id) const {
+        return std::string_view(storage.data() + names[id].offset, names[id].length);
+    }
+
+    unsigned int size() const {
+        return names.size();
+    }
+
+    // Forgets all of the names, but keeps the memory for the next ones
+    void clear() {
+        storage.clear();
+        names.clear();
+        slots.assign(slots.size(), 0);
+        lookupCount = 0;
+        probeCount = 0;
+    }
+
+    // Lookups (interning included) since the last clear, and the taken slots they had to compare against
+    unsigned long getLookupCount() const {
+        return lookupCount;
+    }
+    unsigned long getProbeCount() const {
+        return probeCount;
+    }
+
+    // All of the names, back to back, in the order of interning
+    std::string_view getContents() const {
+        return std::string_view(storage.data(), storage.size());
+    }
+    unsigned int getOffset(unsigned int id) const {
+        return names[id].offset;
+    }
+
+private:
+    struct NameStruct {
+        unsigned int offset;
+        unsigned int length;
+        size_t hash;
+        NameStruct(unsigned int _offset, unsigned int _length, size_t _hash) : offset(_offset), length(_length), hash(_hash) {}
+    };
+
+    int find(std::string_view name, size_t hash) const {
+        lookupCount++;
+        if (slots.size() == 0) return NOT_FOUND;
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            probeCount++;
+            unsigned int id = slots[slot] - 1;
+            if (names[id].hash == hash && getName(id) == name)
+                return id;
+        }
+        return NOT_FOUND;
+    }
+
+    void insertIntoSlots(unsigned int id) {
+        size_t mask = slots.size() - 1;
+        size_t slot = names[id].hash & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = id + 1;
+    }
+
+    void grow() { // Slot count is always a power of 2, and at most half of the slots are taken
+        slots.assign((slots.size() == 0) ? 64 : slots.size() * 2, 0);
+        for (unsigned int id = 0; id < names.size(); id++)
+            insertIntoSlots(id);
+    }
+
+    std::vector<char> storage;
+    std::vector<NameStruct> names;
+    std::vector<unsigned int> slots; // Open addressing with linear probing; a slot holds ID + 1, 0 marks an empty slot
+    mutable unsigned long lookupCount = 0;
+    mutable unsigned long probeCount = 0;
+};
@@ -0,0 +1,245 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+// Changes whenever the same input could be assembled into a different output, so that old cache entries are never used
+const char *ASSEMBLER_VERSION = "asm-4";
+
+// On-disk cache of outputs, by the hash of the input's contents, the assembler version and the options which affect the output
+// Entries are written to a temporary file and renamed into place, so a reader never sees a partial entry; once the entries take up more
+// than the size limit, the least recently used ones (by modification time, which is refreshed on every hit) are removed
+// Size of the entries is kept as a running total (counted once when opening), so the directory is only scanned again once it goes
+// over the limit; the scan also takes in whatever the other processes using the directory have added or removed since
+// Hit/miss counts are summed up over all of the processes which use the directory, within its "stats" file
+class ObjectCache {
+public:
+    ObjectCache() {}
+    ObjectCache(const ObjectCache&) = delete;
+    ObjectCache& operator=(const ObjectCache&) = delete;
+
+    bool open(const std::string& _directory, uint64_t _sizeLimit) {
+        directory = _directory;
+        sizeLimit = _sizeLimit;
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        struct stat directoryStatus;
+        if (stat(directory.c_str(), &directoryStatus) != 0 || S_ISDIR(directoryStatus.st_mode) == false) return false;
+        std::vector<EntryStruct> entries;
+        totalSize = scanEntries(entries);
+        return true;
+    }
+
+    static std::string makeKey(std::string_view contents, std::string_view options) {
+        uint64_t hash = hash64(contents, hash64(options, hash64(ASSEMBLER_VERSION, 0)));
+        char key[17];
+        snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+        return std::string(key);
+    }
+
+    // Copies the cached output into outputPath; returns false on a miss
+    bool fetch(const std::string& key, const char* outputPath) {
+        std::string entryPath = directory + "/" + key;
+        std::vector<char> contents;
+        if (readFile(entryPath.c_str(), contents) == false)
+        {
+            misses++;
+            return false;
+        }
+        if (writeFile(outputPath, contents) == false) return false;
+        utimensat(AT_FDCWD, entryPath.c_str(), nullptr, 0); // Most recently used now
+        hits++;
+        return true;
+    }
+
+    // Stores the output which was just written to outputPath
+    bool store(const std::string& key, const char* outputPath) {
+        std::vector<char> contents;
+        if (readFile(outputPath, contents) == false) return false;
+        std::string temporaryPath = directory + "/.tmp." + std::to_string(getpid()) + "." + std::to_string(temporaryCounter++);
+        if (writeFile(temporaryPath.c_str(), contents) == false || rename(temporaryPath.c_str(), (directory + "/" + key).c_str()) != 0)
+        {
+            unlink(temporaryPath.c_str());
+            return false;
+        }
+        if ((totalSize += contents.size()) > sizeLimit)
+            evict();
+        return true;
+    }
+
+    // Adds this process' counts to the directory's totals; returns the totals (hits, misses, evictions)
+    std::vector<uint64_t> updateStats() {
+        int lock = lockDirectory();
+        std::vector<uint64_t> totals(3, 0);
+        std::vector<char> contents;
+        std::string statsPath = directory + "/stats";
+        if (readFile(statsPath.c_str(), contents) == true)
+        {
+            contents.push_back('\0');
+            unsigned long long values[3] = { 0, 0, 0 };
+            sscanf(contents.data(), "hits %llu misses %llu evictions %llu", &values[0], &values[1], &values[2]);
+            std::copy(values, values + 3, totals.begin());
+        }
+        totals[0] += hits.exchange(0);
+        totals[1] += misses.exchange(0);
+        totals[2] += evictions.exchange(0);
+        std::string text = "hits " + std::to_string(totals[0]) + "\nmisses " + std::to_string(totals[1]) + "\nevictions " + std::to_string(totals[2]) + "\n";
+        std::string temporaryPath = directory + "/.tmp." + std::to_string(getpid()) + ".stats";
+        if (writeFile(temporaryPath.c_str(), std::vector<char>(text.begin(), text.end())) == true)
+            rename(temporaryPath.c_str(), statsPath.c_str());
+        unlockDirectory(lock);
+        return totals;
+    }
+
+    uint64_t getHits() {
+        return hits;
+    }
+    uint64_t getMisses() {
+        return misses;
+    }
+
+private:
+    struct EntryStruct {
+        std::string name;
+        uint64_t size;
+        timespec modified;
+        EntryStruct(const std::string& _name, uint64_t _size, timespec _modified) : name(_name), size(_size), modified(_modified) {}
+    };
+
+    // MurmurHash64A: 8 bytes at a time
+    static uint64_t hash64(std::string_view data, uint64_t seed) {
+        const uint64_t MULTIPLIER = 0xc6a4a7935bd1e995ULL;
+        const int SHIFT = 47;
+        uint64_t hash = seed ^ (data.size() * MULTIPLIER);
+        size_t position = 0;
+        for (; position + 8 <= data.size(); position += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data.data() + position, 8);
+            word *= MULTIPLIER;
+            word ^= word >> SHIFT;
+            word *= MULTIPLIER;
+            hash ^= word;
+            hash *= MULTIPLIER;
+        }
+        if (position < data.size())
+        {
+            for (size_t i = data.size() - position; i > 0; i--)
+                hash ^= (uint64_t)(unsigned char)data[position + i - 1] << (8 * (i - 1));
+            hash *= MULTIPLIER;
+        }
+        hash ^= hash >> SHIFT;
+        hash *= MULTIPLIER;
+        hash ^= hash >> SHIFT;
+        return hash;
+    }
+
+    // Entries within the directory, and their total size
+    uint64_t scanEntries(std::vector<EntryStruct>& entries) {
+        uint64_t size = 0;
+        DIR* directoryStream = opendir(directory.c_str());
+        if (directoryStream != nullptr)
+        {
+            while (dirent* entry = readdir(directoryStream))
+            {
+                if (strlen(entry->d_name) != 16) continue; // Only the entries themselves (16 hex digit keys)
+                struct stat entryStatus;
+                if (stat((directory + "/" + entry->d_name).c_str(), &entryStatus) != 0 || S_ISREG(entryStatus.st_mode) == false) continue;
+                entries.push_back(EntryStruct(entry->d_name, entryStatus.st_size, entryStatus.st_mtim));
+                size += entryStatus.st_size;
+            }
+            closedir(directoryStream);
+        }
+        return size;
+    }
+
+    // Removes the least recently used entries until the rest fits into the size limit
+    void evict() {
+        int lock = lockDirectory();
+        std::vector<EntryStruct> entries;
+        uint64_t size = scanEntries(entries);
+        if (size > sizeLimit)
+        {
+            std::sort(entries.begin(), entries.end(), [](const EntryStruct& first, const EntryStruct& second) {
+                return (first.modified.tv_sec != second.modified.tv_sec) ? first.modified.tv_sec < second.modified.tv_sec : first.modified.tv_nsec < second.modified.tv_nsec;
+            });
+            for (unsigned int i = 0; i < entries.size() && size > sizeLimit; i++)
+                if (unlink((directory + "/" + entries[i].name).c_str()) == 0)
+                {
+                    size -= entries[i].size;
+                    evictions++;
+                }
+        }
+        totalSize = size;
+        unlockDirectory(lock);
+    }
+
+    // Eviction and the stats file are shared by all of the processes (and threads) using the directory
+    int lockDirectory() {
+        int lock = ::open((directory + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock != -1)
+            while (flock(lock, LOCK_EX) != 0 && errno == EINTR) {}
+        return lock;
+    }
+    void unlockDirectory(int lock) {
+        if (lock != -1)
+            ::close(lock); // Releases the lock as well
+    }
+
+    static bool readFile(const char* path, std::vector<char>& contents) {
+        int fileDescriptor = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fileDescriptor == -1) return false;
+        const size_t CHUNK_SIZE = 1 << 16;
+        size_t used = 0;
+        while (true)
+        {
+            contents.resize(used + CHUNK_SIZE);
+            ssize_t count = read(fileDescriptor, contents.data() + used, CHUNK_SIZE);
+            if (count < 0)
+            {
+                if (errno == EINTR) continue;
+                ::close(fileDescriptor);
+                return false;
+            }
+            if (count == 0) break;
+            used += count;
+        }
+        contents.resize(used);
+        ::close(fileDescriptor);
+        return true;
+    }
+    static bool writeFile(const char* path, const std::vector<char>& contents) {
+        int fileDescriptor = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fileDescriptor == -1) return false;
+        size_t done = 0;
+        while (done < contents.size())
+        {
+            ssize_t written = write(fileDescriptor, contents.data() + done, contents.size() - done);
+            if (written < 0)
+            {
+                if (errno == EINTR) continue;
+                ::close(fileDescriptor);
+                return false;
+            }
+            done += written;
+        }
+        return ::close(fileDescriptor) == 0;
+    }
+
+    std::string directory;
+    uint64_t sizeLimit = 0;
+    std::atomic<uint64_t> totalSize{0}; // Of the entries, as far as this process knows
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<unsigned int> temporaryCounter{0};
+};
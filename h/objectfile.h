@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cerrno>
+
+// Binary relocatable object file layout (all of the integers are little-endian, all of the offsets are from the start of the file):
+//   ObjectFileHeader
+//   ObjectSymbol[symbolCount]         - symbol table, in symbol number order (symbol number = index + 1)
+//   ObjectSection[sectionCount]       - one record for each section, in symbol number order
+//   string table                      - all of the symbol names, back to back, without terminators
+//   section data                      - bytes of each section which are not a part of a fill run, back to back
+//   ObjectRelocation[...]             - relocation records, grouped by section
+//   ObjectFill[...]                   - fill runs (.skip, .fill), grouped by section, in the order of their offsets
+// Contents of a section are its fill runs, at their offsets, with the section data filling in all of the bytes in between, in order
+
+const char OBJECT_FILE_MAGIC[4] = { 'A', 'S', 'M', 'O' };
+const uint16_t OBJECT_FILE_VERSION = 2;
+
+struct ObjectFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t symbolCount;
+    uint32_t symbolTableOffset;
+    uint32_t sectionCount;
+    uint32_t sectionTableOffset;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+};
+
+struct ObjectSymbol {
+    enum Flags : uint8_t {
+        DEFINED = 1,
+        EQU = 2
+    };
+    uint32_t nameOffset; // Within the string table
+    uint32_t nameLength;
+    uint32_t sectionNumber;
+    int32_t value;
+    uint8_t scope; // SymbolTableEntry::Scope
+    uint8_t flags;
+    uint16_t reserved;
+};
+
+struct ObjectSection {
+    uint32_t symbolNumber; // Symbol which names the section
+    uint32_t size; // Of the whole contents, fill runs included
+    uint32_t dataOffset;
+    uint32_t dataSize;
+    uint32_t relocationOffset;
+    uint32_t relocationCount;
+    uint32_t fillOffset;
+    uint32_t fillCount;
+};
+
+struct ObjectRelocation {
+    uint32_t offset; // Within the section
+    uint32_t symbolNumber;
+    uint8_t type; // RelocationTableEntry::Type
+    uint8_t reserved[3];
+};
+
+struct ObjectFill {
+    uint32_t offset; // Within the section
+    uint32_t count;
+    uint32_t value; // Little-endian; bytes of a size above 4 beyond the 4th one are 0
+    uint8_t size; // Of each repetition of the value, in bytes (1 to 8)
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(ObjectFileHeader) == 32 && sizeof(ObjectSymbol) == 20 && sizeof(ObjectSection) == 32 && sizeof(ObjectRelocation) == 12 &&
+    sizeof(ObjectFill) == 16, "Object file records must not contain any padding");
+
+// Queues blocks of memory and writes them all out with writev, so section data is never copied nor formatted
+// Queued memory is not owned by the writer and has to stay valid until write is done
+class ObjectFileWriter {
+public:
+    // Returns the offset at which the block is going to be written
+    uint32_t add(const void* data, size_t size) {
+        uint32_t offset = totalSize;
+        if (size > 0)
+        {
+            iovec block;
+            block.iov_base = const_cast<void*>(data);
+            block.iov_len = size;
+            blocks.push_back(block);
+            totalSize += size;
+        }
+        return offset;
+    }
+
+    uint32_t getSize() const {
+        return totalSize;
+    }
+
+    bool write(const char* path) {
+        int fileDescriptor = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor == -1) return false;
+        size_t next = 0; // First block which is not (completely) written yet
+        while (next < blocks.size())
+        {
+            int count = (blocks.size() - next < IOV_MAX) ? blocks.size() - next : IOV_MAX;
+            ssize_t written = writev(fileDescriptor, &blocks[next], count);
+            if (written < 0)
+            {
+                if (errno == EINTR) continue;
+                ::close(fileDescriptor);
+                return false;
+            }
+            // Skip over the blocks which are done; a partially written block is advanced
+            while (next < blocks.size() && written >= (ssize_t)blocks[next].iov_len)
+                written -= blocks[next++].iov_len;
+            if (written > 0)
+            {
+                blocks[next].iov_base = static_cast<char*>(blocks[next].iov_base) + written;
+                blocks[next].iov_len -= written;
+            }
+        }
+        return ::close(fileDescriptor) == 0;
+    }
+
+private:
+    std::vector<iovec> blocks;
+    uint32_t totalSize = 0;
+};
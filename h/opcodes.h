@@ -1,40 +1,128 @@
-#include <string>
-#include <unordered_map>
+#include <string_view>
 
-// Operation codes for all supported instructions
-std::unordered_map<std::string, unsigned int> instructionOperationCodes = std::unordered_map<std::string, unsigned int>({
-    { "halt", 0 },
-    { "iret", 1 },
-    { "ret", 2 },
-    { "int", 3 },
-    { "call", 4 },
-    { "jmp", 5 },
-    { "jeq", 6 },
-    { "jne", 7 },
-    { "jgt", 8 },
-    { "push", 9 },
-    { "pop", 10 },
-    { "xchg", 11 },
-    { "mov", 12 },
-    { "add", 13 },
-    { "sub", 14 },
-    { "mul", 15 },
-    { "div", 16 },
-    { "cmp", 17 },
-    { "not", 18 },
-    { "and", 19 },
-    { "or", 20 },
-    { "xor", 21 },
-    { "test", 22 },
-    { "shl", 23 },
-    { "shr", 24 }
-});
+// Names of all supported instructions; the position of a name is the operation code of the instruction
+constexpr std::string_view INSTRUCTION_NAMES[] = {
+    "halt", "iret", "ret", "int", "call", "jmp", "jeq", "jne", "jgt", "push", "pop", "xchg", "mov", "add", "sub", "mul", "div", "cmp",
+    "not", "and", "or", "xor", "test", "shl", "shr"
+};
+constexpr int INSTRUCTION_COUNT = sizeof(INSTRUCTION_NAMES) / sizeof(INSTRUCTION_NAMES[0]);
 
-// Operation codes for all supported ways of addressing an operand
-std::unordered_map<std::string, unsigned int> addressingOperationCodes = std::unordered_map<std::string, unsigned int>({
-    { "immed", 0 },
-    { "regdir", 1 },
-    { "regind", 2 },
-    { "regindoff", 3 },
-    { "mem", 4 }
-});
\ No newline at end of file
+// Operation code of the instruction, or -1 if there is no such instruction
+// Decided by the length and the first character, so a lookup is at most two comparisons of the whole name; nothing is built at
+// startup, and lookups of constant names are done at compile time
+constexpr int instructionOperationCode(std::string_view name) {
+    switch (name.size())
+    {
+    case 2:
+        if (name == "or") return 20;
+        break;
+    case 3:
+        switch (name[0])
+        {
+        case 'a':
+            if (name == "add") return 13;
+            if (name == "and") return 19;
+            break;
+        case 'c':
+            if (name == "cmp") return 17;
+            break;
+        case 'd':
+            if (name == "div") return 16;
+            break;
+        case 'i':
+            if (name == "int") return 3;
+            break;
+        case 'j':
+            if (name == "jmp") return 5;
+            if (name == "jeq") return 6;
+            if (name == "jne") return 7;
+            if (name == "jgt") return 8;
+            break;
+        case 'm':
+            if (name == "mov") return 12;
+            if (name == "mul") return 15;
+            break;
+        case 'n':
+            if (name == "not") return 18;
+            break;
+        case 'p':
+            if (name == "pop") return 10;
+            break;
+        case 'r':
+            if (name == "ret") return 2;
+            break;
+        case 's':
+            if (name == "sub") return 14;
+            if (name == "shl") return 23;
+            if (name == "shr") return 24;
+            break;
+        case 'x':
+            if (name == "xor") return 21;
+            break;
+        }
+        break;
+    case 4:
+        switch (name[0])
+        {
+        case 'c':
+            if (name == "call") return 4;
+            break;
+        case 'h':
+            if (name == "halt") return 0;
+            break;
+        case 'i':
+            if (name == "iret") return 1;
+            break;
+        case 'p':
+            if (name == "push") return 9;
+            break;
+        case 't':
+            if (name == "test") return 22;
+            break;
+        case 'x':
+            if (name == "xchg") return 11;
+            break;
+        }
+        break;
+    }
+    return -1;
+}
+
+// Names of all supported ways of addressing an operand; the position of a name is the operation code of the addressing mode
+constexpr std::string_view ADDRESSING_NAMES[] = {
+    "immed", "regdir", "regind", "regindoff", "mem"
+};
+constexpr int ADDRESSING_COUNT = sizeof(ADDRESSING_NAMES) / sizeof(ADDRESSING_NAMES[0]);
+
+// Operation code of the addressing mode, or -1 if there is no such addressing mode
+constexpr int addressingOperationCode(std::string_view name) {
+    switch (name.size())
+    {
+    case 3:
+        if (name == "mem") return 4;
+        break;
+    case 5:
+        if (name == "immed") return 0;
+        break;
+    case 6:
+        if (name == "regdir") return 1;
+        if (name == "regind") return 2;
+        break;
+    case 9:
+        if (name == "regindoff") return 3;
+        break;
+    }
+    return -1;
+}
+
+// Both lookups have to agree with the tables of names, and must not find anything else
+constexpr bool operationCodesMatchNames() {
+    for (int i = 0; i < INSTRUCTION_COUNT; i++)
+        if (instructionOperationCode(INSTRUCTION_NAMES[i]) != i)
+            return false;
+    for (int i = 0; i < ADDRESSING_COUNT; i++)
+        if (addressingOperationCode(ADDRESSING_NAMES[i]) != i)
+            return false;
+    return instructionOperationCode("") == -1 && instructionOperationCode("jmpx") == -1 && addressingOperationCode("imm") == -1;
+}
+static_assert(operationCodesMatchNames() == true, "Operation code lookups do not match the tables of names");
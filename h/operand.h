@@ -0,0 +1,113 @@
+#include <string_view>
+
+// Instruction operand, decoded from its text by decodeOperand; value points into the decoded text
+struct Operand {
+    enum Mode { // Values are the operation codes of the addressing modes
+        IMMED = addressingOperationCode("immed"),
+        REGDIR = addressingOperationCode("regdir"),
+        REGIND = addressingOperationCode("regind"),
+        REGINDOFF = addressingOperationCode("regindoff"),
+        MEM = addressingOperationCode("mem")
+    };
+    Mode mode = IMMED;
+    bool immediate = false; // '$' prefix (non-branch instructions)
+    bool indirect = false; // '*' prefix (branch instructions)
+    unsigned int registerNumber = 0; // Register based modes; 7 for %pc/%r7 as well
+    bool pcRelative = false; // Offset register was written as %pc/%r7
+    bool isSymbol = false;
+    std::string_view value; // Literal or symbol (value, address or offset), as written
+    unsigned long literal = 0; // Value of the literal (wraps around if it does not fit)
+};
+
+// Decodes an operand in a single left to right scan, without any allocation; returns false if the text is not an operand
+// Branch instructions: *?literal, *?symbol, *%rN, *(%rN), *literal(%rN), *symbol(%rN|%pc/%r7)
+// Other instructions: $?literal, $?symbol, %rN, (%rN), literal(%rN), symbol(%rN|%pc/%r7)
+// A literal or a symbol on its own is immediate when written as 'literal' for branches and as '$literal' for the others, and a
+// memory address otherwise
+inline bool decodeOperand(std::string_view text, bool isBranch, Operand& operand) {
+    operand = Operand();
+    size_t position = 0;
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    auto isLetter = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+    auto scanRegister = [&](bool allowPc) { // %r[0-7] or, if allowed, %pc/%r7
+        if (text.substr(position, 2) == "%r" && position + 2 < text.size() && text[position + 2] >= '0' && text[position + 2] <= '7')
+        {
+            operand.registerNumber = text[position + 2] - '0';
+            position += 3;
+            return true;
+        }
+        if (allowPc && text.substr(position, 7) == "%pc/%r7")
+        {
+            operand.registerNumber = 7;
+            operand.pcRelative = true;
+            position += 7;
+            return true;
+        }
+        return false;
+    };
+    if (position < text.size() && text[position] == (isBranch ? '*' : '$'))
+    {
+        operand.indirect = isBranch;
+        operand.immediate = (isBranch == false);
+        position++;
+    }
+    // Register based addressing requires '*' for branch instructions and does not allow '$' for the others
+    bool registerAllowed = (operand.indirect == isBranch && operand.immediate == false);
+    if (position == text.size()) return false;
+    char c = text[position];
+    if (c == '%')
+    { // Register direct
+        if (registerAllowed == false || scanRegister(false) == false) return false;
+        operand.mode = Operand::REGDIR;
+        return position == text.size();
+    }
+    if (c == '(')
+    { // Register indirect
+        position++;
+        if (registerAllowed == false || scanRegister(false) == false || position == text.size() || text[position] != ')') return false;
+        operand.mode = Operand::REGIND;
+        return position + 1 == text.size();
+    }
+    size_t start = position;
+    if (isDigit(c))
+    { // [1-9][0-9]*|0x[0-9]+|0x[a-fA-F]+|0
+        unsigned int base = 10;
+        if (c == '0' && position + 1 < text.size() && text[position + 1] == 'x')
+        {
+            base = 16;
+            position += 2;
+        }
+        size_t digitsStart = position;
+        for (; position < text.size(); position++)
+        {
+            char digit = text[position];
+            if (isDigit(digit))
+                operand.literal = operand.literal * base + (digit - '0');
+            else if (base == 16 && ((digit >= 'a' && digit <= 'f') || (digit >= 'A' && digit <= 'F')))
+                operand.literal = operand.literal * base + ((digit | 0x20) - 'a' + 10);
+            else
+                break;
+        }
+        if (position == digitsStart) return false;
+    }
+    else if (isLetter(c))
+    { // [a-zA-Z]\w*
+        while (position < text.size() && (isLetter(text[position]) || isDigit(text[position]) || text[position] == '_')) position++;
+        operand.isSymbol = true;
+    }
+    else
+        return false;
+    operand.value = text.substr(start, position - start);
+    if (position == text.size())
+    {
+        operand.mode = (operand.immediate || (isBranch && operand.indirect == false)) ? Operand::IMMED : Operand::MEM;
+        return true;
+    }
+    if (text[position] != '(')
+        return false;
+    // Register indirect with an offset (a literal offset can not be PC relative)
+    position++;
+    if (registerAllowed == false || scanRegister(operand.isSymbol) == false || position == text.size() || text[position] != ')') return false;
+    operand.mode = Operand::REGINDOFF;
+    return position + 1 == text.size();
+}
@@ -0,0 +1,222 @@
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Contents, relocation data and saved location counter of one section
+// Contents are the emitted bytes, with fill runs (.skip, .fill) in between them; a run is only recorded as its offset, count, size
+// and value, so reserving a large block costs the same as reserving a small one. Offsets are always offsets within the whole
+// contents (runs included), while data holds only the bytes which were emitted one by one
+class Section {
+public:
+    // count repetitions of the size byte (little-endian) value
+    struct FillRun {
+        unsigned int offset;
+        unsigned int dataPosition; // Number of bytes of data before the run
+        unsigned int count;
+        unsigned int size;
+        uint32_t value;
+        FillRun(unsigned int _offset, unsigned int _dataPosition, unsigned int _count, unsigned int _size, uint32_t _value) :
+            offset(_offset), dataPosition(_dataPosition), count(_count), size(_size), value(_value) {}
+        uint64_t getLength() const { // Counts merged into one run can get past 32 bits before the size is applied
+            return (uint64_t)count * size;
+        }
+        unsigned char byteAt(unsigned int runOffset) const {
+            unsigned int shift = 8 * (runOffset % size);
+            return (shift < 32) ? (unsigned char)((value >> shift) & 0xFF) : 0;
+        }
+    };
+
+    // Sizes of the contents and of the relocation table at some point, so whatever gets emitted after it can be copied out
+    struct Mark {
+        unsigned int size = 0;
+        unsigned int dataSize = 0;
+        unsigned int fillRunCount = 0;
+        unsigned int lastRunCount = 0; // Count of the last run (a fill can continue it)
+        unsigned int relocationCount = 0;
+    };
+    // Contents and relocation data emitted after a mark; appending them to a section emits the same as emitting them one by one did
+    struct Piece {
+        std::vector<char> data;
+        std::vector<FillRun> fillRuns; // dataPosition is within the data of the piece; offset is not used
+        unsigned int continuedCount = 0; // Added onto the run which was the last one at the mark
+        unsigned int continuedSize = 0;
+        uint32_t continuedValue = 0;
+        std::vector<RelocationTableEntry> relocations; // Offsets are from the start of the piece
+    };
+
+    Section(unsigned int _sectionNumber) : sectionNumber(_sectionNumber) {}
+
+    unsigned int getSectionNumber() {
+        return sectionNumber;
+    }
+
+    // Bytes which were emitted one by one (without the fill runs)
+    std::vector<char>& getData() {
+        return data;
+    }
+    const std::vector<FillRun>& getFillRuns() {
+        return fillRuns;
+    }
+    // Size of the whole contents
+    unsigned int getSize() {
+        return data.size() + fillLength;
+    }
+
+    void emitByte(char byte) {
+        data.push_back(byte);
+    }
+    // Runs shorter than MIN_FILL_RUN bytes are emitted byte by byte, so the contents do not get split into many small pieces
+    // The whole contents, this run included, must fit into 32-bit offsets (which is checked before a fill is emitted)
+    void emitFill(unsigned int count, unsigned int size, uint32_t value) {
+        uint64_t length = (uint64_t)count * size;
+        if (length < MIN_FILL_RUN)
+        {
+            FillRun run(0, 0, count, size, value);
+            for (unsigned int i = 0; i < run.getLength(); i++)
+                data.push_back((char)run.byteAt(i));
+            return;
+        }
+        if (fillRuns.empty() == false)
+        { // Continues the previous run, if nothing was emitted since
+            FillRun &last = fillRuns.back();
+            if (last.offset + last.getLength() == getSize() && last.size == size && last.value == value)
+            {
+                last.count += count;
+                fillLength += length;
+                return;
+            }
+        }
+        fillRuns.push_back(FillRun(getSize(), data.size(), count, size, value));
+        fillLength += length;
+    }
+
+    // Adds the value to the 2-byte (little-endian) word at the offset; the word is always one which was emitted byte by byte
+    void addToWord(unsigned int offset, int value) {
+        unsigned int position = dataPosition(offset);
+        int word = (unsigned char)data[position] | ((unsigned char)data[position + 1] << 8);
+        word += value;
+        data[position] = (char)(word & 0xFF);
+        data[position + 1] = (char)((word >> 8) & 0xFF);
+    }
+    // Adds the value to the byte at the offset, the same way
+    void addToByte(unsigned int offset, int value) {
+        unsigned int position = dataPosition(offset);
+        data[position] = (char)(((unsigned char)data[position] + value) & 0xFF);
+    }
+
+    // Copies count bytes of the contents, starting from the offset, into bytes; fill runs are expanded only here
+    void read(unsigned int offset, unsigned int count, unsigned char *bytes) {
+        // First run which ends after the offset
+        unsigned int run = std::upper_bound(fillRuns.begin(), fillRuns.end(), offset, [](unsigned int position, const FillRun &fillRun) {
+            return position < fillRun.offset + fillRun.getLength();
+        }) - fillRuns.begin();
+        unsigned int end = offset + count;
+        while (offset < end)
+        {
+            if (run < fillRuns.size() && offset >= fillRuns[run].offset)
+            { // Within the run
+                const FillRun &fillRun = fillRuns[run];
+                unsigned int runEnd = std::min<uint64_t>(end, fillRun.offset + fillRun.getLength());
+                for (; offset < runEnd; offset++)
+                    *bytes++ = fillRun.byteAt(offset - fillRun.offset);
+                if (offset == fillRun.offset + fillRun.getLength())
+                    run++;
+            }
+            else
+            { // Emitted bytes, up to the next run
+                unsigned int bytesEnd = (run < fillRuns.size()) ? std::min(end, fillRuns[run].offset) : end;
+                unsigned int position = dataPosition(offset, run);
+                std::copy(data.begin() + position, data.begin() + position + (bytesEnd - offset), bytes);
+                bytes += bytesEnd - offset;
+                offset = bytesEnd;
+            }
+        }
+    }
+
+    Mark mark() {
+        Mark mark;
+        mark.size = getSize();
+        mark.dataSize = data.size();
+        mark.fillRunCount = fillRuns.size();
+        mark.lastRunCount = (fillRuns.empty() == true) ? 0 : fillRuns.back().count;
+        mark.relocationCount = relocationTable.size();
+        return mark;
+    }
+    void copySince(const Mark &mark, Piece &piece) {
+        piece.data.assign(data.begin() + mark.dataSize, data.end());
+        piece.fillRuns.assign(fillRuns.begin() + mark.fillRunCount, fillRuns.end());
+        for (FillRun &run : piece.fillRuns)
+            run.dataPosition -= mark.dataSize;
+        piece.continuedCount = 0;
+        if (mark.fillRunCount > 0 && fillRuns[mark.fillRunCount - 1].count != mark.lastRunCount)
+        {
+            const FillRun &continued = fillRuns[mark.fillRunCount - 1];
+            piece.continuedCount = continued.count - mark.lastRunCount;
+            piece.continuedSize = continued.size;
+            piece.continuedValue = continued.value;
+        }
+        piece.relocations.clear();
+        for (auto it = relocationTable.begin() + mark.relocationCount; it != relocationTable.end(); it++)
+            piece.relocations.push_back(RelocationTableEntry(it->getOffset() - mark.size, it->getType(), it->getSymbolNumber()));
+    }
+    // The piece can be appended at any offset; only the words which depend on where it is are left for the caller to patch
+    void append(const Piece &piece) {
+        unsigned int start = getSize();
+        if (piece.continuedCount > 0)
+            emitFill(piece.continuedCount, piece.continuedSize, piece.continuedValue);
+        unsigned int position = 0;
+        for (const FillRun &run : piece.fillRuns)
+        {
+            data.insert(data.end(), piece.data.begin() + position, piece.data.begin() + run.dataPosition);
+            emitFill(run.count, run.size, run.value);
+            position = run.dataPosition;
+        }
+        data.insert(data.end(), piece.data.begin() + position, piece.data.end());
+        for (RelocationTableEntry relocation : piece.relocations)
+            addRelocation(RelocationTableEntry(start + relocation.getOffset(), relocation.getType(), relocation.getSymbolNumber()));
+    }
+
+    std::vector<RelocationTableEntry>& getRelocationTable() {
+        return relocationTable;
+    }
+    void addRelocation(RelocationTableEntry relocation) {
+        relocationTable.push_back(relocation);
+        addedRelocationCount++;
+    }
+    // Relocations added so far; the ones which were not needed in the end are erased from the table, but still counted here
+    unsigned int getAddedRelocationCount() {
+        return addedRelocationCount;
+    }
+
+    // Location counter is only saved here while some other section is being processed
+    void setLocationCounter(unsigned int _locationCounter) {
+        locationCounter = _locationCounter;
+    }
+    unsigned int getLocationCounter() {
+        return locationCounter;
+    }
+
+private:
+    static const unsigned int MIN_FILL_RUN = 64; // Bytes
+
+    // Position within data of the emitted byte at the offset; nextRun is the first run after the offset
+    unsigned int dataPosition(unsigned int offset, unsigned int nextRun) {
+        if (nextRun == 0) return offset;
+        const FillRun &previous = fillRuns[nextRun - 1];
+        return previous.dataPosition + (offset - (previous.offset + previous.getLength()));
+    }
+    unsigned int dataPosition(unsigned int offset) {
+        unsigned int nextRun = std::upper_bound(fillRuns.begin(), fillRuns.end(), offset, [](unsigned int position, const FillRun &fillRun) {
+            return position < fillRun.offset;
+        }) - fillRuns.begin();
+        return dataPosition(offset, nextRun);
+    }
+
+    unsigned int sectionNumber; // Equals to the number of the section's symbol
+    std::vector<char> data;
+    std::vector<FillRun> fillRuns; // In the order of their offsets
+    unsigned int fillLength = 0; // Of all of the runs
+    std::vector<RelocationTableEntry> relocationTable;
+    unsigned int addedRelocationCount = 0;
+    unsigned int locationCounter = 0;
+};
@@ -0,0 +1,115 @@
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read-only view of a whole source file: regular files are memory mapped, anything else (e.g. a pipe) is read in one go
+// Lines are handed out as views into that memory, so no line is ever copied
+class SourceFile {
+public:
+    SourceFile() {}
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile() {
+        close();
+    }
+
+    bool open(const char* path) {
+        close();
+        int fileDescriptor = ::open(path, O_RDONLY);
+        if (fileDescriptor == -1) return false;
+        struct stat fileStatus;
+        if (fstat(fileDescriptor, &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) && fileStatus.st_size > 0)
+        {
+            void* address = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (address != MAP_FAILED)
+            {
+                madvise(address, fileStatus.st_size, MADV_SEQUENTIAL);
+                mapping = address;
+                size = fileStatus.st_size;
+                data = static_cast<const char*>(address);
+                ::close(fileDescriptor);
+                return true;
+            }
+        }
+        // Not a regular file (or it could not be mapped) - read all of it
+        bool success = readAll(fileDescriptor);
+        ::close(fileDescriptor);
+        return success;
+    }
+
+    void close() {
+        if (mapping != nullptr)
+            munmap(mapping, size);
+        mapping = nullptr;
+        buffer = std::vector<char>();
+        data = nullptr;
+        size = 0;
+        position = 0;
+    }
+
+    // Same splitting as std::getline: the '\n' is not a part of the line, and there is no empty line after the final '\n'
+    bool nextLine(std::string_view& line) {
+        if (position >= size) return false;
+        const char* start = data + position;
+        const char* newLine = static_cast<const char*>(memchr(start, '\n', size - position));
+        size_t length = (newLine != nullptr) ? newLine - start : size - position;
+        line = std::string_view(start, length);
+        position += length + 1;
+        return true;
+    }
+
+    std::string_view getContents() const {
+        return std::string_view(data, size);
+    }
+
+    // Next piece of (at least) chunkSize bytes, or the rest of the file; a piece ends right after a '\n' (or at the end of the file),
+    // so splitting the pieces into lines, one after another, gives the same lines as nextLine does
+    bool nextChunk(size_t chunkSize, std::string_view& chunk) {
+        if (position >= size) return false;
+        size_t end = (chunkSize < size - position) ? position + chunkSize : size;
+        const char* newLine = (end < size) ? static_cast<const char*>(memchr(data + end - 1, '\n', size - end + 1)) : nullptr;
+        end = (newLine != nullptr) ? newLine - data + 1 : size;
+        chunk = std::string_view(data + position, end - position);
+        position = end;
+        return true;
+    }
+
+    static void splitLines(std::string_view chunk, std::vector<std::string_view>& lines) {
+        size_t position = 0;
+        while (position < chunk.size())
+        {
+            size_t newLine = chunk.find('\n', position);
+            size_t length = (newLine != std::string_view::npos) ? newLine - position : chunk.size() - position;
+            lines.push_back(chunk.substr(position, length));
+            position += length + 1;
+        }
+    }
+
+private:
+    bool readAll(int fileDescriptor) {
+        const size_t CHUNK_SIZE = 1 << 16;
+        size_t used = 0;
+        while (true)
+        {
+            buffer.resize(used + CHUNK_SIZE);
+            ssize_t count = read(fileDescriptor, buffer.data() + used, CHUNK_SIZE);
+            if (count < 0) return false;
+            if (count == 0) break;
+            used += count;
+        }
+        buffer.resize(used);
+        data = buffer.data();
+        size = used;
+        return true;
+    }
+
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t position = 0; // Start of the next line
+    void* mapping = nullptr; // Set only if the file is memory mapped
+    std::vector<char> buffer; // Holds the contents if the file is not memory mapped
+};
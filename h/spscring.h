@@ -0,0 +1,54 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed size queue between exactly one producer thread and exactly one consumer thread
+// There are no locks: the producer only ever writes writeIndex, the consumer only ever writes readIndex (capacity must be a power of 2)
+template <typename T>
+class SpscRing {
+public:
+    SpscRing(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    bool tryPush(T& item) {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == slots.size()) return false; // Full
+        slots[write & mask] = std::move(item);
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+    bool tryPop(T& item) {
+        size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire)) return false; // Empty
+        item = std::move(slots[read & mask]);
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Waits for as long as the queue is full; the time spent waiting is added to stallTime
+    void push(T& item, std::chrono::nanoseconds& stallTime) {
+        if (tryPush(item) == true) return;
+        auto start = std::chrono::steady_clock::now();
+        while (tryPush(item) == false)
+            std::this_thread::yield();
+        stallTime += std::chrono::steady_clock::now() - start;
+    }
+    // Waits for as long as the queue is empty; the time spent waiting is added to stallTime
+    void pop(T& item, std::chrono::nanoseconds& stallTime) {
+        if (tryPop(item) == true) return;
+        auto start = std::chrono::steady_clock::now();
+        while (tryPop(item) == false)
+            std::this_thread::yield();
+        stallTime += std::chrono::steady_clock::now() - start;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> writeIndex{0}; // Indexes only ever grow; slot = index & mask
+    alignas(64) std::atomic<size_t> readIndex{0};
+};
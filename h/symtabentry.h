@@ -1,11 +1,11 @@
-#include <string>
-#include <list>
-
+// A use of a symbol which was not yet defined when it was referenced; once the symbol is defined (it has to be, otherwise it is an error),
+// value of the symbol is being added on the 2-byte word at offset patch within the section
 struct ForwardReferenceStruct {
     unsigned int patch;
     unsigned int sectionNumber;
+    unsigned int symbolNumber;
     char sign;
-    ForwardReferenceStruct(unsigned int _patch, unsigned int _sectionNumber, char _sign = '+') : patch(_patch), sectionNumber(_sectionNumber), sign(_sign) {}
+    ForwardReferenceStruct(unsigned int _patch, unsigned int _sectionNumber, unsigned int _symbolNumber, char _sign = '+') : patch(_patch), sectionNumber(_sectionNumber), symbolNumber(_symbolNumber), sign(_sign) {}
 };
 
 class SymbolTableEntry {
@@ -15,32 +15,43 @@ public:
         GLOBAL,
         EXTERN
     };
-    static unsigned int numGenerator; // Generates numbers starting from 1, ascending
     static const unsigned int UNDEFINED_SECTION_NUMBER;
    
-    SymbolTableEntry(std::string _name) : name(_name), scope(LOCAL), defined(false), sectionNumber(0) {}
-    
-    SymbolTableEntry(std::string _name, ForwardReferenceStruct forwardReference) : name(_name), scope(LOCAL), defined(false), sectionNumber(0) { // Used when symbol is not yet defined, but it is referenced (for the first time)
-        forwardReferences.push_back(forwardReference);
-    }
+    // Used when symbol is not yet defined, but it is referenced (for the first time)
+    SymbolTableEntry(unsigned int _nameId) : nameId(_nameId), scope(LOCAL), defined(false), sectionNumber(0) {}
     // Used when symbol is being defined and referenced (for the first time) at the same time
-    SymbolTableEntry(std::string _name, unsigned int _sectionNumber, int _value) : name(_name), sectionNumber(_sectionNumber), value(_value), scope(LOCAL), defined(true) {}
+    SymbolTableEntry(unsigned int _nameId, unsigned int _sectionNumber, int _value) : nameId(_nameId), sectionNumber(_sectionNumber), value(_value), scope(LOCAL), defined(true) {}
     // Used when symbol is being referenced (for the first time) within an .global/.extern
-    SymbolTableEntry(std::string _name, bool isExtern) : name(_name), defined(false) {
-        if (isExtern == true) {
-            sectionNumber = 0;
+    SymbolTableEntry(unsigned int _nameId, bool isExtern) : nameId(_nameId), defined(false), sectionNumber(UNDEFINED_SECTION_NUMBER) {
+        if (isExtern == true)
             scope = EXTERN;
-        }
         else
             scope = GLOBAL;
     }
 
+    // Same number, section, scope and kind as the other entry (names and values are not compared)
+    bool sameAs(const SymbolTableEntry &other) const {
+        return number == other.number && sectionNumber == other.sectionNumber && scope == other.scope && defined == other.defined &&
+            isEqu == other.isEqu;
+    }
+    // Takes over the section, value, scope and kind of the other entry; the name and the number are kept
+    void copyStateFrom(const SymbolTableEntry &other) {
+        sectionNumber = other.sectionNumber;
+        value = other.value;
+        scope = other.scope;
+        defined = other.defined;
+        isEqu = other.isEqu;
+    }
+
+    void setNumber(unsigned int _number) { // Symbol number equals to the position within the symbol table + 1
+        number = _number;
+    }
     unsigned int getNumber() {
         return number;
     }
 
-    std::string getSymbolName() {
-        return name;
+    unsigned int getNameId() { // Name itself is kept within the NameArena
+        return nameId;
     }
 
     void setSectionNumber(unsigned int _sectionNumber) {
@@ -74,16 +85,6 @@ public:
         return defined;
     }
 
-    std::list<ForwardReferenceStruct> getFowardsReferences() {
-        return forwardReferences;
-    }
-    void addForwardReference(ForwardReferenceStruct forwardReference) {
-        forwardReferences.push_back(forwardReference);
-    }
-    void resetForwardRefernces() {
-        forwardReferences = std::list<ForwardReferenceStruct>();
-    }
-
     void setEquToTrue() {
         isEqu = true;
     }
@@ -92,18 +93,13 @@ public:
     }
 
 private:
-    unsigned int number = numGenerator++;
-    std::string name;
+    unsigned int number = 0;
+    unsigned int nameId;
     unsigned int sectionNumber;
     int value = 0;
     Scope scope;
     bool defined;
-    // All of the forward references towards a symbol that is not yet defined are stored within a list;
-    // each element of the list contains one unsigned int value which equals to the value of the location counter when referencing a non-defined symbol
-    // once that symbol is defined (it has to be, otherwise it is an error), value of the symbol is being added on this very unsigned int value
-    std::list<ForwardReferenceStruct> forwardReferences;
     bool isEqu = false; 
 };
 
-const unsigned int SymbolTableEntry::UNDEFINED_SECTION_NUMBER = 0;
-unsigned int SymbolTableEntry::numGenerator = 1;
\ No newline at end of file
+const unsigned int SymbolTableEntry::UNDEFINED_SECTION_NUMBER = 0;
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include <charconv>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Buffered writer for the text dump: numbers are formatted in place (std::to_chars, hex lookup table) and the
+// buffer is handed to the file in large blocks
+class TextOutputBuffer {
+public:
+    static const size_t FLUSH_THRESHOLD = 1 << 20;
+
+    TextOutputBuffer() {
+        buffer.resize(FLUSH_THRESHOLD + RESERVE);
+    }
+    TextOutputBuffer(const TextOutputBuffer&) = delete;
+    TextOutputBuffer& operator=(const TextOutputBuffer&) = delete;
+    ~TextOutputBuffer() {
+        close();
+    }
+
+    bool open(const char* path) {
+        fileDescriptor = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        failed = (fileDescriptor == -1);
+        return failed == false;
+    }
+    bool close() { // Returns false if anything could not be written
+        if (fileDescriptor != -1)
+        {
+            flush();
+            if (::close(fileDescriptor) != 0) failed = true;
+            fileDescriptor = -1;
+        }
+        return failed == false;
+    }
+
+    void append(std::string_view text) {
+        if (text.size() > RESERVE)
+        { // Too big to be copied into the reserve - write it out directly
+            flush();
+            writeAll(text.data(), text.size());
+            return;
+        }
+        memcpy(reserve(text.size()), text.data(), text.size());
+        commit(text.size());
+    }
+    void append(char c) {
+        *reserve(1) = c;
+        commit(1);
+    }
+    template <typename T>
+    void appendDecimal(T value) {
+        char* start = reserve(MAX_NUMBER_LENGTH);
+        commit(std::to_chars(start, start + MAX_NUMBER_LENGTH, value).ptr - start);
+    }
+    void appendHex(unsigned int value) { // Upper case, without leading zeros (as "%X")
+        char* start = reserve(MAX_NUMBER_LENGTH);
+        char* end = std::to_chars(start, start + MAX_NUMBER_LENGTH, value, 16).ptr;
+        for (char* c = start; c != end; c++)
+            if (*c >= 'a') *c -= 'a' - 'A';
+        commit(end - start);
+    }
+    void appendHexByte(unsigned char value) { // Always two upper case digits (as "%.2X")
+        memcpy(reserve(2), HEX_TABLE.pairs[value], 2);
+        commit(2);
+    }
+    // Writes 16 bytes as upper case hex digit pairs, separated by spaces
+    void appendHexRow(const unsigned char* bytes) {
+        char* out = reserve(48);
+#ifdef __SSE2__
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+        __m128i lowMask = _mm_set1_epi8(0x0F);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(data, 4), lowMask);
+        __m128i low = _mm_and_si128(data, lowMask);
+        __m128i highDigits = toHexDigits(high);
+        __m128i lowDigits = toHexDigits(low);
+        alignas(16) char digits[32];
+        _mm_store_si128(reinterpret_cast<__m128i*>(digits), _mm_unpacklo_epi8(highDigits, lowDigits));
+        _mm_store_si128(reinterpret_cast<__m128i*>(digits + 16), _mm_unpackhi_epi8(highDigits, lowDigits));
+        for (int i = 0; i < 16; i++)
+        {
+            out[3 * i] = digits[2 * i];
+            out[3 * i + 1] = digits[2 * i + 1];
+            out[3 * i + 2] = ' ';
+        }
+#else
+        for (int i = 0; i < 16; i++)
+        {
+            memcpy(out + 3 * i, HEX_TABLE.pairs[bytes[i]], 2);
+            out[3 * i + 2] = ' ';
+        }
+#endif
+        commit(47); // No space after the last pair
+    }
+
+    void flush() {
+        if (used > 0)
+            writeAll(buffer.data(), used);
+        used = 0;
+    }
+
+private:
+    static const size_t RESERVE = 4096; // Space which is always available past the flush threshold
+    static const size_t MAX_NUMBER_LENGTH = 24;
+
+    struct HexTable {
+        char pairs[256][2];
+        HexTable() {
+            const char* digits = "0123456789ABCDEF";
+            for (int i = 0; i < 256; i++)
+            {
+                pairs[i][0] = digits[i >> 4];
+                pairs[i][1] = digits[i & 0xF];
+            }
+        }
+    };
+    static const HexTable HEX_TABLE;
+
+#ifdef __SSE2__
+    static __m128i toHexDigits(__m128i nibbles) { // '0' + n, plus 7 more for n > 9 ('A' - '9' - 1)
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8(7));
+        return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    }
+#endif
+
+    // Returned space is valid for at most RESERVE bytes
+    char* reserve(size_t size) {
+        if (used + size > FLUSH_THRESHOLD)
+            flush();
+        return buffer.data() + used;
+    }
+    void commit(size_t size) {
+        used += size;
+    }
+
+    void writeAll(const char* data, size_t size) {
+        while (size > 0 && failed == false)
+        {
+            ssize_t written = write(fileDescriptor, data, size);
+            if (written < 0)
+            {
+                if (errno != EINTR) failed = true;
+                continue;
+            }
+            data += written;
+            size -= written;
+        }
+    }
+
+    std::vector<char> buffer;
+    size_t used = 0;
+    int fileDescriptor = -1;
+    bool failed = false;
+};
+
+const TextOutputBuffer::HexTable TextOutputBuffer::HEX_TABLE;
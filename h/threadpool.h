@@ -0,0 +1,149 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <ctime>
+
+// CPU time used by the calling thread so far, in seconds
+inline double threadCpuSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Runs sets of independent jobs on a number of threads, which are started once and wait for the next set in between
+// Jobs are dealt out to the workers' own queues up front; a worker takes jobs from the front of its own queue, and once that is empty,
+// steals from the back of the other workers' queues, so a worker which got the long jobs does not hold everyone else up
+class WorkStealingPool {
+public:
+    WorkStealingPool(unsigned int _workerCount) : workerCount((_workerCount == 0) ? 1 : _workerCount), queues(workerCount) {
+        for (unsigned int worker = 1; worker < workerCount; worker++)
+            threads.emplace_back([this, worker]() { serve(worker); });
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    unsigned int getWorkerCount() {
+        return workerCount;
+    }
+
+    // Calls job(worker, jobNumber) once for each job number from 0 to jobCount - 1, and returns once all of them are done
+    // Worker 0 is the calling thread; jobs given to the same worker never run at the same time
+    void run(unsigned int jobCount, const std::function<void(unsigned int, unsigned int)> &job) {
+        deal(jobCount, job, 0);
+        work(0, currentJob);
+        wait();
+    }
+    // Same as run, except that it returns right away, and the jobs are run only by the pool's own threads (by the calling thread, if
+    // there are none); wait has to be called before the next set of jobs is started
+    void start(unsigned int jobCount, const std::function<void(unsigned int, unsigned int)> &job) {
+        deal(jobCount, job, (workerCount > 1) ? 1 : 0);
+        if (workerCount == 1)
+            work(0, currentJob);
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        done.wait(lock, [this]() { return busyWorkers == 0; });
+    }
+
+    // CPU time the pool's own threads spent on the jobs (the calling thread's time is not included), in seconds
+    double getHelperCpuSeconds() {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return helperCpuSeconds;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<unsigned int> jobs;
+    };
+
+    // Jobs go to the queues of the workers from firstWorker on; every thread of the pool is woken up, and counts as busy until it finds
+    // no more jobs to take or steal
+    void deal(unsigned int jobCount, const std::function<void(unsigned int, unsigned int)> &job, unsigned int firstWorker) {
+        for (unsigned int jobNumber = 0; jobNumber < jobCount; jobNumber++)
+        {
+            WorkerQueue &queue = queues[firstWorker + jobNumber % (workerCount - firstWorker)];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(jobNumber);
+        }
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            currentJob = job;
+            busyWorkers = threads.size();
+            round++;
+        }
+        wakeUp.notify_all();
+    }
+
+    void serve(unsigned int worker) {
+        unsigned int seenRound = 0;
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (true)
+        {
+            wakeUp.wait(lock, [this, seenRound]() { return stopping == true || round != seenRound; });
+            if (stopping == true)
+                return;
+            seenRound = round;
+            lock.unlock();
+            double cpuStart = threadCpuSeconds();
+            work(worker, currentJob);
+            double cpu = threadCpuSeconds() - cpuStart;
+            lock.lock();
+            helperCpuSeconds += cpu;
+            if (--busyWorkers == 0)
+                done.notify_all();
+        }
+    }
+
+    void work(unsigned int worker, const std::function<void(unsigned int, unsigned int)> &job) {
+        unsigned int jobNumber;
+        while (takeOwn(worker, jobNumber) == true || steal(worker, jobNumber) == true)
+            job(worker, jobNumber);
+    }
+
+    bool takeOwn(unsigned int worker, unsigned int &jobNumber) {
+        std::lock_guard<std::mutex> lock(queues[worker].mutex);
+        if (queues[worker].jobs.empty() == true) return false;
+        jobNumber = queues[worker].jobs.front();
+        queues[worker].jobs.pop_front();
+        return true;
+    }
+
+    // No new jobs are added until the set is done, so once every queue is found empty, the worker is done
+    bool steal(unsigned int worker, unsigned int &jobNumber) {
+        for (unsigned int i = 1; i < workerCount; i++)
+        {
+            WorkerQueue &victim = queues[(worker + i) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.jobs.empty() == true) continue;
+            jobNumber = victim.jobs.back();
+            victim.jobs.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    unsigned int workerCount;
+    std::vector<WorkerQueue> queues;
+    std::vector<std::thread> threads; // Workers 1 and on
+    std::mutex stateMutex; // Guards everything below
+    std::condition_variable wakeUp; // A new set of jobs was dealt out, or the pool is stopping
+    std::condition_variable done; // No thread of the pool is busy any more
+    std::function<void(unsigned int, unsigned int)> currentJob;
+    unsigned int round = 0; // Sets of jobs dealt out so far
+    unsigned int busyWorkers = 0;
+    bool stopping = false;
+    double helperCpuSeconds = 0;
+};
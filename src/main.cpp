@@ -1,1503 +1,1866 @@
 #include "opcodes.h"
 #include "regexes.h"
+#include "lexer.h"
+#include "operand.h"
+#include "namearena.h"
+#include "sourcefile.h"
+#include "objectfile.h"
+#include "textwriter.h"
 #include "symtabentry.h"
 #include "reltabentry.h"
+#include "section.h"
 #include "equtabentry.h"
+#include "diagnostics.h"
+#include "assembler.h"
+#include "threadpool.h"
+#include "spscring.h"
+#include "filewatcher.h"
+#include "objectcache.h"
 #include <iostream>
-#include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <vector>
+#include <sys/resource.h>
 
-int currentSectionNumber = -1; // -1 for a section number means no section is currently being processed
-// Location counter is being reset back to 0, for each new section
-unsigned int locationCounter = 0;
-// One section can be split into multiple .section directives; therefore, when continuing one section, location counter must not be reset back to 0
-// sectionLocationCounters stores location counters for all processed sections, so they can be restored if one of those sections continues
-std::unordered_map<int, unsigned int> sectionLocationCounters;
-// Symbol table
-std::vector<SymbolTableEntry> symbolTable;
-// Relocation table - one for each section
-std::unordered_map<int, std::vector<RelocationTableEntry>> sectionRelocationTables;
-// For each section, ...
-std::unordered_map<int, std::vector<char>> outputFileData;
-// EQU Symbol table
-std::vector<EquTableEntry> equSymbolTable;
+const char *DEFAULT_INPUT_PATH = "/home/student/Desktop/asm_program.txt";
+const char *DEFAULT_TEXT_OUTPUT_PATH = "/home/student/Desktop/output_file.txt";
+const char *DEFAULT_BINARY_OUTPUT_PATH = "/home/student/Desktop/output_file.o";
 
-void processLabelDefinition(std::string &label)
+Assembler::Assembler()
+{ // Capacity reserved up front is kept for all of the files, since reset only clears the tables
+    diagnostics.setStream(std::cout);
+    sections.reserve(INITIAL_SECTION_CAPACITY);
+    sectionIndexes.reserve(INITIAL_SYMBOL_CAPACITY);
+    symbolTable.reserve(INITIAL_SYMBOL_CAPACITY);
+    symbolTableIndex.reserve(INITIAL_SYMBOL_CAPACITY);
+    forwardReferences.reserve(INITIAL_SYMBOL_CAPACITY);
+}
+
+void Assembler::reset()
 {
-    auto it = symbolTable.begin();
-    for (; it != symbolTable.end(); it++)
+    currentSectionNumber = -1;
+    currentSection = nullptr;
+    locationCounter = 0;
+    sections.clear();
+    sectionIndexes.clear();
+    symbolTable.clear();
+    equSymbolTable.clear();
+    equSymbolIndex.clear();
+    forwardReferences.clear();
+    symbolNames.clear();
+    symbolTableIndex.clear();
+    lineCount = 0;
+    encodedLineCount = 0;
+    recordedBlock = nullptr;
+    stats = StatsStruct();
+    currentLine = 0;
+    diagnostics.clear();
+}
+
+// CPU time is counted per thread, so assemblies running at the same time (-j) do not count each other's time
+void Assembler::startPhase()
+{
+    phaseStart = std::chrono::steady_clock::now();
+    phaseStartCpu = threadCpuSeconds() + helperCpuSeconds;
+    phaseStartStats = getStats();
+}
+
+void Assembler::endPhase(const char *name)
+{
+    auto now = std::chrono::steady_clock::now();
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu = threadCpuSeconds() + helperCpuSeconds;
+    StatsStruct current = getStats();
+    phases.push_back(PhaseStruct(name, std::chrono::duration<double>(now - phaseStart).count(), cpu - phaseStartCpu, usage.ru_maxrss,
+        current.since(phaseStartStats)));
+    phaseStart = now;
+    phaseStartCpu = cpu;
+    phaseStartStats = current;
+}
+
+Assembler::StatsStruct Assembler::StatsStruct::since(const StatsStruct &start) const
+{
+    StatsStruct difference = *this;
+    for (unsigned int kind = 0; kind <= LineRecord::TWOADDR_INSTRUCTION; kind++)
+        difference.lines[kind] -= start.lines[kind];
+    difference.lexerRuns -= start.lexerRuns;
+    difference.regexSearches -= start.regexSearches;
+    difference.symbolLookups -= start.symbolLookups;
+    difference.symbolLookupProbes -= start.symbolLookupProbes;
+    difference.patchedForwardReferences -= start.patchedForwardReferences;
+    difference.addedRelocations -= start.addedRelocations;
+    difference.erasedRelocations -= start.erasedRelocations;
+    difference.emittedBytes -= start.emittedBytes;
+    difference.readerStallSeconds -= start.readerStallSeconds;
+    difference.parserStallSeconds -= start.parserStallSeconds;
+    difference.processingStallSeconds -= start.processingStallSeconds;
+    return difference;
+}
+
+// Counters kept by the Assembler itself, plus the ones which follow from the tables (lookups, relocations, bytes)
+Assembler::StatsStruct Assembler::getStats()
+{
+    StatsStruct current = stats;
+    current.symbolLookups = symbolNames.getLookupCount();
+    current.symbolLookupProbes = symbolNames.getProbeCount();
+    for (Section &section : sections)
     {
-        if (it->getSymbolName() == label)
-        { // Label already exists within the symbol table
-            if (it->getDefined() == true)
-            { // Multiple definitions of the same label are not allowed
-                std::cout << "Multiple definitions of the same label are not allowed!\n";
-                // exit(2);
-            }
-            else
-            { // Label is being defined
-                it->setDefinedToTrue();
-                it->setSectionNumber(currentSectionNumber);
-                it->setSymbolValue(locationCounter);
-            }
-            return;
+        current.addedRelocations += section.getAddedRelocationCount();
+        current.erasedRelocations += section.getAddedRelocationCount() - section.getRelocationTable().size();
+        current.emittedBytes += section.getSize();
+    }
+    return current;
+}
+
+bool Assembler::assemble(const char *inputPath)
+{
+    reset();
+    phases.clear();
+    startPhase();
+    SourceFile assemblyFile;
+    if (assemblyFile.open(inputPath) == false)
+        return false;
+    endPhase("read");
+    if (incremental == true)
+        processLinesIncrementally(assemblyFile);
+    else if (pipelined == true)
+        processLinesPipelined(assemblyFile);
+    else if (parseThreads > 1)
+        processLinesInParallel(assemblyFile);
+    else
+    {
+        std::string_view line;
+        while (assemblyFile.nextLine(line))
+        {
+            processLine(line);
+        }
+    }
+    endPhase("lines");
+    diagnostics.setLine(0);
+    processNonEquForwardReferences();
+    processEquValues();
+    processEquForwardReferences();
+    endPhase("symbols");
+    diagnostics.flush();
+    return true;
+}
+
+std::vector<SymbolTableEntry>::iterator Assembler::findSymbol(std::string_view name)
+{
+    int nameId = symbolNames.find(name);
+    if (nameId == NameArena::NOT_FOUND || (unsigned int)nameId >= symbolTableIndex.size() || symbolTableIndex[nameId] == -1)
+        return symbolTable.end();
+    if (recordedBlock != nullptr)
+        noteUsedSymbol(symbolTable[symbolTableIndex[nameId]]);
+    return symbolTable.begin() + symbolTableIndex[nameId];
+}
+
+void Assembler::addSymbol(SymbolTableEntry symbol)
+{
+    if (symbol.getNameId() >= symbolTableIndex.size())
+        symbolTableIndex.resize(symbol.getNameId() + 1, -1);
+    symbolTableIndex[symbol.getNameId()] = symbolTable.size();
+    symbol.setNumber(symbolTable.size() + 1);
+    symbolTable.push_back(symbol);
+}
+
+Section *Assembler::getSection(unsigned int sectionNumber)
+{
+    if (sectionNumber >= sectionIndexes.size() || sectionIndexes[sectionNumber] == -1)
+        return nullptr;
+    return &sections[sectionIndexes[sectionNumber]];
+}
+
+void Assembler::processLabelDefinition(std::string_view label)
+{
+    auto it = findSymbol(label);
+    if (it != symbolTable.end())
+    { // Label already exists within the symbol table
+        if (it->getDefined() == true)
+        { // Multiple definitions of the same label are not allowed
+            diagnostics.error("Multiple definitions of the same label are not allowed!");
+            // exit(2);
         }
+        else
+        { // Label is being defined
+            it->setDefinedToTrue();
+            it->setSectionNumber(currentSectionNumber);
+            it->setSymbolValue(locationCounter);
+            noteValueSet(*it);
+            noteValueUse(ValueUseStruct::SYMBOL, it->getNumber(), 0, 1);
+        }
+        return;
     }
     // Label does not exist within the symbol table
-    symbolTable.push_back(SymbolTableEntry(label, currentSectionNumber, locationCounter));
+    addSymbol(SymbolTableEntry(symbolNames.intern(label), currentSectionNumber, locationCounter));
+    noteValueUse(ValueUseStruct::SYMBOL, symbolTable.size(), 0, 1);
 }
 
-void processGlobal(std::string &symbol, bool isExtern)
+void Assembler::processGlobal(std::string_view symbol, bool isExtern)
 {
-    auto it = symbolTable.begin();
-    for (; it != symbolTable.end(); it++)
-    {
-        if (it->getSymbolName() == symbol)
-        { // Symbol already exists within the symbol table
-            if (isExtern == false)
-                it->setSymbolScopeToGlobal();
-            else
+    auto it = findSymbol(symbol);
+    if (it != symbolTable.end())
+    { // Symbol already exists within the symbol table
+        if (isExtern == false)
+            it->setSymbolScopeToGlobal();
+        else
+        {
+            if (it->getDefined())
             {
-                if (it->getDefined())
-                {
-                    std::cout << "Symbol is already defined as non-extern symbol!\n";
-                    return;
-                }
-                it->setSymbolScopeToExtern();
+                diagnostics.error("Symbol is already defined as non-extern symbol!");
+                return;
             }
-            return;
+            it->setSymbolScopeToExtern();
         }
+        return;
     }
     // Symbol does not exist within the symbol table
-    symbolTable.push_back(SymbolTableEntry(symbol, isExtern));
+    addSymbol(SymbolTableEntry(symbolNames.intern(symbol), isExtern));
 }
 
-void processSection(std::string &section)
+void Assembler::processSection(std::string_view section)
 {
-    if (currentSectionNumber != -1)
+    if (currentSection != nullptr)
     { // Not the first section
         // Saving the current section's location counter
-        if (sectionLocationCounters.find(currentSectionNumber) == sectionLocationCounters.end())
-        { // Section is being processed for the first time
-            sectionLocationCounters.insert({{currentSectionNumber, locationCounter}});
-        }
-        else
-        { // A part of a section has been processed before
-            sectionLocationCounters[currentSectionNumber] = locationCounter;
-        }
+        currentSection->setLocationCounter(locationCounter);
     }
     // Check if the new section is already in the symbol table
-    auto it = symbolTable.begin();
-    for (; it != symbolTable.end(); it++)
-    {
-        if (it->getSymbolName() == section)
-        { // Section is already in the symbol table?
-            if (it->getNumber() != it->getSectionNumber())
-            { // There already is a symbol with such name
-                std::cout << "Invalid section name! There already is a symbol with such name!\n";
-                return; // exit(3);
-            }
-            if (currentSectionNumber != it->getSectionNumber())
-            {                                                                      // Are current and new section the same section?
-                locationCounter = sectionLocationCounters[it->getSectionNumber()]; // Restore location counter for the new section
-                currentSectionNumber = it->getSectionNumber();
-            }
-            return;
+    auto it = findSymbol(section);
+    if (it != symbolTable.end())
+    { // Section is already in the symbol table?
+        if (it->getNumber() != it->getSectionNumber())
+        { // There already is a symbol with such name
+            diagnostics.error("Invalid section name! There already is a symbol with such name!");
+            return; // exit(3);
+        }
+        if (currentSectionNumber != it->getSectionNumber())
+        { // Are current and new section the same section?
+            currentSection = getSection(it->getSectionNumber());
+            locationCounter = currentSection->getLocationCounter(); // Restore location counter for the new section
+            currentSectionNumber = it->getSectionNumber();
         }
+        return;
     }
     // Section is not in the symbol table
     locationCounter = 0;
-    symbolTable.push_back(SymbolTableEntry(section, symbolTable.size() + 1, 0));
+    addSymbol(SymbolTableEntry(symbolNames.intern(section), symbolTable.size() + 1, 0));
     currentSectionNumber = symbolTable.size();
+    sectionIndexes.resize(currentSectionNumber + 1, -1);
+    sectionIndexes[currentSectionNumber] = sections.size();
+    sections.push_back(Section(currentSectionNumber));
+    currentSection = &sections.back();
 }
 
-void processMemoryAllocation(unsigned int option, const std::vector<std::string> &symbols)
-{ // 1 - .byte; 2 - .word; 3 - .skip
-    std::smatch matches;
-    if (option == 3)
-    { // .skip directive
-        unsigned long literalValue;
-        if (std::regex_search(symbols[0], matches, HEX_REGEX)) // Hexadecimal value
-            literalValue = std::stoul(symbols[0], nullptr, 16);
-        else // Decimal value
-            literalValue = std::stoul(symbols[0]);
-        std::cout << "Literal's value is: " << literalValue << "\n";
-        for (int i = 0; i < literalValue; i++)
-            if (outputFileData.find(currentSectionNumber) != outputFileData.end())
-                outputFileData[currentSectionNumber].push_back(0);
-            else
-                outputFileData.insert({{currentSectionNumber, std::vector<char>({0})}});
-        locationCounter += literalValue;
+void Assembler::processMemoryAllocation(unsigned int option, std::string_view items)
+{ // 1 - .byte; 2 - .word; 3 - .skip; 4 - .fill
+    ListScanner scanner(items);
+    std::string_view item;
+    if (option == 3 || option == 4)
+    { // .skip directive (count zero bytes), or .fill directive (count, size in bytes - 1 by default, at most 8 - and value - 0 by default)
+        unsigned long literalValues[3] = { 0, 1, 0 };
+        for (unsigned int i = 0; i < 3 && scanner.next(item); i++)
+        {
+            literalValues[i] = literalValue(item);
+            TRACE("Literal's value is: " << literalValues[i] << "\n");
+        }
+        unsigned long size = std::min(literalValues[1], 8UL); // Bytes of the value beyond the 4th one are 0
+        if (size > 0 && literalValues[0] > (UINT32_MAX - locationCounter) / size)
+        { // Offsets within a section are 32-bit
+            diagnostics.error("Memory allocation directive does not fit into the section!");
+            return;
+        }
+        if (size == 0)
+            return; // Nothing to emit, whatever the count
+        currentSection->emitFill(literalValues[0], size, literalValues[2]);
+        locationCounter += literalValues[0] * size;
         return;
     }
-    unsigned short size; // In bytes
-    if (option == 1)
-        size = 1;
-    else if (option == 2)
-        size = 2;
-    for (const std::string &symbol : symbols)
+    unsigned short size = (option == 1) ? 1 : 2; // In bytes
+    // Items are taken from the line one at a time and emitted straight away, so a list of any length is a single pass over the line
+    while (scanner.next(item))
     {
-        if (std::regex_search(symbol, matches, HEX_REGEX))
-        { // Hexadecimal literal
-            unsigned long literalValue = std::stoul(symbol, nullptr, 16);
-            if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(literalValue & 0xFF)})}});
-            else
-                outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-            if (size == 2)
-                outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-        }
-        else if (std::regex_search(symbol, matches, DEC_REGEX))
-        { // Decimal literal
-            unsigned long literalValue = std::stoul(symbol);
-            if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(literalValue & 0xFF)})}});
-            else
-                outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFFUL));
+        if (item[0] >= '0' && item[0] <= '9')
+        { // Literal
+            unsigned long value = literalValue(item);
+            currentSection->emitByte((char)(value & 0xFF));
             if (size == 2)
-                outputFileData[currentSectionNumber].push_back((literalValue >> 8) & 0xFF);
+                currentSection->emitByte((char)((value >> 8) & 0xFF));
         }
         else
         { // Symbol
-            auto it = symbolTable.begin();
-            for (; it != symbolTable.end(); it++)
+            auto it = findSymbol(item);
+            if (it != symbolTable.end())
             {
-                if (it->getSymbolName() == symbol)
+                if (it->getNumber() == it->getSectionNumber())
                 {
-                    if (it->getNumber() == it->getSectionNumber())
-                    {
-                        std::cout << "Section names are not allowed inside of memory allocation directives!\n";
-                        return; // exit(4);
+                    diagnostics.error("Section names are not allowed inside of memory allocation directives!");
+                    return; // exit(4);
+                }
+                else
+                {
+                    if (it->getDefined() == false)
+                    { // Symbol is not yet defined
+                        currentSection->emitByte(0);
+                        if (size == 2)
+                            currentSection->emitByte(0);
+                        currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
+                        forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, it->getNumber())); // Adding forward reference
                     }
                     else
-                    {
-                        if (it->getDefined() == false)
-                        { // Symbol is not yet defined
-                            if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                                outputFileData.insert({{currentSectionNumber, std::vector<char>({0})}});
-                            else
-                                outputFileData[currentSectionNumber].push_back(0);
-                            if (size == 2)
-                                outputFileData[currentSectionNumber].push_back(0);
-                            if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                            else
-                                sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                            it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber)); // Adding forward reference
-                        }
-                        else
-                        { // Symbol is already defined
-                            int symbolValue = it->getSymbolValue();
-                            if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                                outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(symbolValue & 0xFF)})}});
-                            else
-                                outputFileData[currentSectionNumber].push_back((char)(symbolValue & 0xFF));
-                            if (size == 2)
-                                outputFileData[currentSectionNumber].push_back((char)((symbolValue >> 8) & 0xFF));
-                            if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                sectionRelocationTables.insert({{currentSectionNumber,
-                                                                 std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                            else
-                                sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        }
+                    { // Symbol is already defined
+                        int symbolValue = it->getSymbolValue();
+                        currentSection->emitByte((char)(symbolValue & 0xFF));
+                        if (size == 2)
+                            currentSection->emitByte((char)((symbolValue >> 8) & 0xFF));
+                        currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
+                        noteValueUse((size == 1) ? ValueUseStruct::BYTE : ValueUseStruct::WORD, locationCounter, it->getNumber(), 1);
                     }
-                    break;
                 }
             }
-            if (it == symbolTable.end()) {
-                // Symbol has not yet been refernced
-                symbolTable.push_back(SymbolTableEntry(symbol, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({0})}});
-                else
-                    outputFileData[currentSectionNumber].push_back(0);
+            else
+            { // Symbol has not yet been refernced
+                addSymbol(SymbolTableEntry(symbolNames.intern(item)));
+                forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, symbolTable.size()));
+                currentSection->emitByte(0);
                 if (size == 2)
-                    outputFileData[currentSectionNumber].push_back(0);
-                if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                    sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                else
-                    sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                            
+                    currentSection->emitByte(0);
+                currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size()));
             }
         }
         locationCounter += size;
     }
 }
 
-void processInstruction(std::string &name, const std::vector<std::string> &operands = std::vector<std::string>(), bool isBranch = false)
+// Adds the 2-byte value of the symbol (absolute), at the location counter
+void Assembler::emitSymbolValue(std::string_view symbolName)
 {
-    if (currentSectionNumber == -1)
+    auto it = findSymbol(symbolName);
+    if (it == symbolTable.end())
+    { // Symbol has not yet been defined/referenced
+        addSymbol(SymbolTableEntry(symbolNames.intern(symbolName)));
+        forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, symbolTable.size()));
+        currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size()));
+        // Operand bytes
+        currentSection->emitByte(0);
+        currentSection->emitByte(0);
+    }
+    else
     {
-        std::cout << "Instruction directive must be a part of a section!\n";
-        return; // exit(...);
+        if (it->getDefined() == false)
+        {
+            forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, it->getNumber()));
+            currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
+            // Operand bytes
+            currentSection->emitByte(0);
+            currentSection->emitByte(0);
+        }
+        else // Symbol is defined
+        {
+            currentSection->addRelocation(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
+            // Operand bytes
+            currentSection->emitByte((char)(it->getSymbolValue() & 0xFF));
+            currentSection->emitByte((char)((it->getSymbolValue() >> 8) & 0xFF));
+            noteValueUse(ValueUseStruct::WORD, locationCounter, it->getNumber(), 1);
+        }
     }
-    if (operands.size() == 0)
-    { // Non-address instruction
-        short data = instructionOperationCodes[name] << 3;
-        if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-            outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-        else
-            outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-        locationCounter++;
+    locationCounter += 2;
+}
+
+// Adds the 2-byte offset of register indirect addressing with the symbol's value as the offset, at the location counter
+// Offset off of register 7 (the PC) is relative to the end of the operand; it needs no relocation data if the symbol is local and
+// within the current section
+void Assembler::emitSymbolOffset(std::string_view symbolName, unsigned int registerNumber)
+{
+    auto it = findSymbol(symbolName);
+    RelocationTableEntry::Type type = (registerNumber == 7) ? RelocationTableEntry::RELATIVE : RelocationTableEntry::ABSOLUTE;
+    int dataValue = (registerNumber == 7) ? -2 : 0;
+    if (it == symbolTable.end())
+    { // Symbol has not yet been defined/referenced
+        addSymbol(SymbolTableEntry(symbolNames.intern(symbolName)));
+        forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, symbolTable.size()));
+        currentSection->addRelocation(RelocationTableEntry(locationCounter, type, symbolTable.size()));
     }
-    else if (operands.size() == 1)
+    else
     {
-        std::smatch matches;
-        short data = instructionOperationCodes[name] << 3;
-        if (isBranch == true)
-        { // Branch instruction
-            if (std::regex_search(operands[0], matches, LITERAL_REGEX))
-            {
-                std::string literal = matches.str(2);
-                unsigned long literalValue;
-                if (std::regex_search(operands[0], matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                if (operands[0][0] == '*')
-                {
-                    std::cout << "Branch instruction operand is a literal (actual operand is in memory): " << matches.str(2) << "\n";
-                    data |= 1; // Set size bit to 1 - operand's size is 2 bytes for memory addressing
-                    // OC and size byte
-                    if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                        outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                    else
-                        outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                    // Operand bytes
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                    locationCounter += 4;
-                }
-                else
-                {
-                    std::cout << "Branch instruction operand is a literal: " << matches.str(2) << "\n";
-                    if (literalValue > 255) // 2 bytes are needed for the operand
-                        data |= 1;
-                    // OC and size bits
-                    if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                        outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                    else
-                        outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["immed"] << 5));
-                    // Operand byte(s)
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    if (literalValue > 255) // 2 bytes are needed for the operand
-                        outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                    locationCounter += (literalValue > 255) ? 4 : 3;
-                }
-            }
-            else if (std::regex_search(operands[0], matches, SYMBOL_REGEX))
-            {
-                data |= 1; // Set size bit to 1 - operand's size is 2 bytes for memory addressing
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                if (matches.str(1) == "*")
-                {
-                    std::cout << "Branch instruction operand is a symbol (actual operand is in memory): " << matches.str(2) << "\n";
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                }
-                else
-                {
-                    std::cout << "Branch instruction operand is a symbol: " << matches.str(2) << "\n";
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["immed"] << 5));
-                }
-                locationCounter += 2;
-                std::string symbolName = matches.str(2);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size()));
-                    // Operand bytes
-                    outputFileData[currentSectionNumber].push_back(0);
-                    outputFileData[currentSectionNumber].push_back(0);
-                }
-                else
-                {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back(0);
-                        outputFileData[currentSectionNumber].push_back(0);
-                    }
-                    else // Symbol is defined
-                    {
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back((char)(it->getSymbolValue() & 0xFF));
-                        outputFileData[currentSectionNumber].push_back((char)((it->getSymbolValue() >> 8) & 0xFF));
-                    }
-                }
-                locationCounter += 2;
-            }
-            else if (std::regex_search(operands[0], matches, REGISTER_REGEX))
+        if (it->getDefined() == false)
+        {
+            forwardReferences.push_back(ForwardReferenceStruct(locationCounter, currentSectionNumber, it->getNumber()));
+            currentSection->addRelocation(RelocationTableEntry(locationCounter, type, it->getNumber()));
+        }
+        else // Symbol is defined
+        {
+            if (it->getSymbolScope() == SymbolTableEntry::LOCAL)
             {
-                std::cout << "Branch instruction operand is a register!\n";
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                if (matches.str(2)[0] == '(')
-                {
-                    std::cout << "Register indirect! Register number: " << matches.str(2)[3] << "\n";
-                    char regNum = matches.str(2)[3];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regind"] << 5) | (registerNumber << 1)));
+                if (currentSectionNumber == it->getSectionNumber() && registerNumber == 7)
+                { // Constant offset - no relocation data needed
+                    dataValue = it->getSymbolValue() - locationCounter - 2;
+                    noteValueUse(ValueUseStruct::WORD, locationCounter, 0, -1);
                 }
                 else
-                {
-                    std::cout << "Register direct! Register number: " << matches.str(2)[2] << "\n";
-                    char regNum = matches.str(2)[2];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regdir"] << 5) | (registerNumber << 1)));
+                { // Relocation data is needed
+                    dataValue += it->getSymbolValue();
+                    currentSection->addRelocation(RelocationTableEntry(locationCounter, type, it->getNumber()));
                 }
-                locationCounter += 2;
+                noteValueUse(ValueUseStruct::WORD, locationCounter, it->getNumber(), 1);
             }
-            else if (std::regex_search(operands[0], matches, LITREG_REGEX))
+            else if (it->getSymbolScope() == SymbolTableEntry::GLOBAL)
             {
-                std::cout << "Branch instruction operand is a register with literal offset!\n";
-                std::cout << "Literal offset is: " << matches.str(3) << "\n";
-                std::cout << "Register number is: " << matches.str(4) << "\n";
-                std::string literal = matches.str(3);
-                int registerNumber = std::stoi(matches.str(4));
-                data |= 1; // Operand size for register indirect with offset is 2 bytes
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                unsigned long literalValue;
-                if (std::regex_search(literal, matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                locationCounter += 4;
-            }
-            else if (std::regex_search(operands[0], matches, SYMREG_REGEX))
-            {
-                std::cout << "Branch instruction operand is a register? with symbol's value offset!\n";
-                std::cout << "Symbol is: " << matches.str(3) << "\n";
-                data |= 1; // Operand size for register indirect with offset is 2 bytes
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                int registerNumber;
-                if (matches.str(4)[1] == 'p')
-                {
-                    std::cout << "PC relative!\n";
-                    registerNumber = 7;
-                }
-                else
-                {
-                    std::cout << "Register number is: " << matches.str(4)[2] << "\n";
-                    char regNum = matches.str(4)[2];
-                    registerNumber = std::atoi(&regNum);
-                }
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                locationCounter += 2;
-                std::string symbolName = matches.str(3);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                RelocationTableEntry::Type type = (registerNumber == 7) ? RelocationTableEntry::RELATIVE : RelocationTableEntry::ABSOLUTE;
-                int dataValue = (registerNumber == 7) ? -2 : 0;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, symbolTable.size()));
-                }
-                else
-                {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                    }
-                    else // Symbol is defined
-                    {
-                        if (it->getSymbolScope() == SymbolTableEntry::LOCAL)
-                        {
-                            if (currentSectionNumber == it->getSectionNumber() && registerNumber == 7) // Constant offset - no relocation data needed
-                                dataValue = it->getSymbolValue() - locationCounter - 2;
-                            else
-                            { // Relocation data is needed
-                                dataValue += it->getSymbolValue();
-                                if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                    sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                                else
-                                    sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                            }
-                        }
-                        else if (it->getSymbolScope() == SymbolTableEntry::GLOBAL)
-                        {
-                            if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                            else
-                                sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                        }
-                    }
-                }
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(dataValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((dataValue >> 8) & 0xFF));
-                locationCounter += 2;
+                currentSection->addRelocation(RelocationTableEntry(locationCounter, type, it->getNumber()));
             }
         }
+    }
+    // Operand bytes
+    currentSection->emitByte((char)(dataValue & 0xFF));
+    currentSection->emitByte((char)((dataValue >> 8) & 0xFF));
+    locationCounter += 2;
+}
+
+void Assembler::traceOperand(const Operand &operand, bool isBranch)
+{
+    if (diagnostics.tracing() == false)
+        return;
+    const char *prefix = (isBranch == true) ? "Branch instruction operand is " : "One address instruction operand is ";
+    switch (operand.mode)
+    {
+    case Operand::REGDIR:
+    case Operand::REGIND:
+        TRACE(prefix << "a register!\n");
+        TRACE(((operand.mode == Operand::REGIND) ? "Register indirect!" : "Register direct!") << " Register number: " << operand.registerNumber << "\n");
+        break;
+    case Operand::REGINDOFF:
+        if (operand.isSymbol == false)
+        {
+            TRACE(prefix << "a register with literal offset!\n");
+            TRACE("Literal offset is: " << operand.value << "\n");
+            TRACE("Register number is: " << operand.registerNumber << "\n");
+        }
         else
-        { // One address, non-branch instruction
-            if (std::regex_search(operands[0], matches, LITERAL_REGEX))
-            {
-                std::string literal = matches.str(2);
-                unsigned long literalValue;
-                if (std::regex_search(literal, matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                if (operands[0][0] == '$')
-                {
-                    std::cout << "One address instruction operand is an immediate value: " << matches.str(2) << "\n";
-                    if (name == "pop")
-                    {
-                        std::cout << "Immediate addressing is not allowed for the destination operand!\n";
-                        return;
-                    }
-                    if (literalValue > 255)
-                        data |= 1;
-                    // OC and size byte
-                    if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                        outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                    else
-                        outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["imm"] << 5));
-                    // Operand byte(s)
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    if (literalValue > 255)
-                    {
-                        outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                        locationCounter += 4;
-                    }
-                    else
-                        locationCounter += 3;
-                }
-                else
-                {
-                    std::cout << "One address instruction operand is in memory (literal stores the location): " << matches.str(2) << "\n";
-                    data |= 1;
-                    // OC and size byte
-                    if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                        outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                    else
-                        outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                    // Operand byte(s)
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                    locationCounter += 4;
-                }
-            }
-            else if (std::regex_search(operands[0], matches, SYMBOL_REGEX))
-            {
-                data |= 1; // Set size bit to 1 - operand's size is 2 bytes for memory addressing
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                if (matches.str(1) == "$")
-                {
-                    std::cout << "One address instruction operand is an immediate value (equals to the symbol's value): " << matches.str(2) << "\n";
-                    if (name == "pop")
-                    {
-                        std::cout << "Immediate addressing is not allowed for the destination operand!\n";
-                        return;
-                    }
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["immed"] << 5));
-                }
-                else
-                {
-                    std::cout << "One address instruction operand is in memory (symbol's value is the location): " << matches.str(2) << "\n";
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                }
-                locationCounter += 2;
-                std::string symbolName = matches.str(2);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size()));
-                    // Operand bytes
-                    outputFileData[currentSectionNumber].push_back(0);
-                    outputFileData[currentSectionNumber].push_back(0);
-                }
-                else
-                {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back(0);
-                        outputFileData[currentSectionNumber].push_back(0);
-                    }
-                    else // Symbol is defined
-                    {
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back((char)(it->getSymbolValue() & 0xFF));
-                        outputFileData[currentSectionNumber].push_back((char)((it->getSymbolValue() >> 8) & 0xFF));
-                    }
-                }
-                locationCounter += 2;
-            }
-            else if (std::regex_search(operands[0], matches, REGISTER_REGEX))
-            {
-                std::cout << "One address instruction operand is a register!\n";
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                if (matches.str(2)[0] == '(')
-                {
-                    std::cout << "Register indirect! Register number: " << matches.str(2)[3] << "\n";
-                    char regNum = matches.str(2)[3];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regind"] << 5) | (registerNumber << 1)));
-                }
-                else
-                {
-                    std::cout << "Register direct! Register number: " << matches.str(2)[2] << "\n";
-                    char regNum = matches.str(2)[2];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regdir"] << 5) | (registerNumber << 1)));
-                }
-                locationCounter += 2;
-            }
-            else if (std::regex_search(operands[0], matches, LITREG_REGEX))
-            {
-                std::cout << "One address instruction operand is a register with literal offset!\n";
-                std::cout << "Literal offset is: " << matches.str(3) << "\n";
-                std::cout << "Register number is: " << matches.str(4) << "\n";
-                std::string literal = matches.str(3);
-                int registerNumber = std::stoi(matches.str(4));
-                data |= 1; // Operand size for register indirect with offset is 2 bytes
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                unsigned long literalValue;
-                if (std::regex_search(literal, matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                locationCounter += 4;
-            }
-            else if (std::regex_search(operands[0], matches, SYMREG_REGEX))
-            {
-                std::cout << "One address instruction operand is a register? with symbol's value offset!\n";
-                std::cout << "Symbol is: " << matches.str(3) << "\n";
-                data |= 1; // Operand size for register indirect with offset is 2 bytes
-                // OC and size byte
-                if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-                    outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-                else
-                    outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
-                int registerNumber;
-                if (matches.str(4)[1] == 'p')
-                {
-                    std::cout << "PC relative!\n";
-                    registerNumber = 7;
-                }
-                else
-                {
-                    std::cout << "Register number is: " << matches.str(4)[2] << "\n";
-                    char regNum = matches.str(4)[2];
-                    registerNumber = std::atoi(&regNum);
-                }
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                locationCounter += 2;
-                std::string symbolName = matches.str(3);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                RelocationTableEntry::Type type = (registerNumber == 7) ? RelocationTableEntry::RELATIVE : RelocationTableEntry::ABSOLUTE;
-                int dataValue = (registerNumber == 7) ? -2 : 0;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, symbolTable.size()));
-                }
-                else
-                {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                    }
-                    else // Symbol is defined
-                    {
-                        if (it->getSymbolScope() == SymbolTableEntry::LOCAL)
-                        {
-                            if (currentSectionNumber == it->getSectionNumber() && registerNumber == 7) // Constant offset - no relocation data needed
-                                dataValue = it->getSymbolValue() - locationCounter - 2;
-                            else
-                            { // Relocation data is needed
-                                dataValue += it->getSymbolValue();
-                                if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                    sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                                else
-                                    sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                            }
-                        }
-                        else if (it->getSymbolScope() == SymbolTableEntry::GLOBAL)
-                        {
-                            if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                            else
-                                sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                        }
-                    }
-                }
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(dataValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((dataValue >> 8) & 0xFF));
-                locationCounter += 2;
-            }
+        {
+            TRACE(prefix << "a register? with symbol's value offset!\n");
+            TRACE("Symbol is: " << operand.value << "\n");
+            if (operand.pcRelative == true)
+                TRACE("PC relative!\n");
+            else
+                TRACE("Register number is: " << operand.registerNumber << "\n");
         }
+        break;
+    default: // Literal or symbol on its own
+        if (isBranch == true)
+            TRACE(prefix << ((operand.isSymbol == true) ? "a symbol" : "a literal") << ((operand.mode == Operand::MEM) ? " (actual operand is in memory)" : "")
+                << ": " << operand.value << "\n");
+        else if (operand.mode == Operand::IMMED)
+            TRACE(prefix << "an immediate value" << ((operand.isSymbol == true) ? " (equals to the symbol's value)" : "") << ": " << operand.value << "\n");
+        else
+            TRACE(prefix << "in memory" << ((operand.isSymbol == true) ? " (symbol's value is the location)" : " (literal stores the location)")
+                << ": " << operand.value << "\n");
+        break;
     }
-    else if (operands.size() == 2)
-    { // Two-address instruction
-        std::smatch matches;
-        short data = (instructionOperationCodes[name] << 3) | 1;
+}
+
+// Encoder of one kind of operand (the operand description byte and the operand bytes), for one class of instructions
+// Branch and one address instructions start with their OC and size byte (data, with the size bit not yet set), as the size depends
+// on their only operand; two address instructions always have 2-byte operands, so their OC and size byte is emitted beforehand
+template <LineRecord::Kind instructionKind, Operand::Mode mode, bool isSymbol>
+void Assembler::encodeOperand(const Operand &operand, short data)
+{
+    // Register direct/indirect operands have no operand bytes, immediate literals have as many as they need, and the rest have 2
+    constexpr bool registerOnly = (mode == Operand::REGDIR || mode == Operand::REGIND);
+    constexpr bool alwaysWord = (registerOnly == false && (mode != Operand::IMMED || isSymbol == true));
+    bool word = alwaysWord || (mode == Operand::IMMED && operand.literal > 255);
+    if constexpr (instructionKind != LineRecord::TWOADDR_INSTRUCTION)
+    {
         // OC and size byte
-        if (outputFileData.find(currentSectionNumber) == outputFileData.end())
-            outputFileData.insert({{currentSectionNumber, std::vector<char>({(char)(data & 0xFF)})}});
-        else
-            outputFileData[currentSectionNumber].push_back((char)(data & 0xFF));
+        currentSection->emitByte((char)((data | (word ? 1 : 0)) & 0xFF));
         locationCounter++;
-        for (int i = 0; i < 2; i++)
+    }
+    // Operand description byte
+    currentSection->emitByte((char)((mode << 5) | (operand.registerNumber << 1)));
+    locationCounter++;
+    if constexpr (registerOnly == true)
+        return;
+    else if constexpr (isSymbol == false)
+    { // Operand byte(s)
+        currentSection->emitByte((char)(operand.literal & 0xFF));
+        if (word == true)
+            currentSection->emitByte((char)((operand.literal >> 8) & 0xFF));
+        locationCounter += (word == true) ? 2 : 1;
+    }
+    else if constexpr (mode == Operand::REGINDOFF)
+        emitSymbolOffset(operand.value, operand.registerNumber);
+    else
+        emitSymbolValue(operand.value);
+}
+
+// Encoders of all the kinds of operands, by kind of instruction (branch, one address, two address), addressing mode and whether the operand's value is a symbol (register
+// direct/indirect operands have no value)
+#define OPERAND_ENCODERS_OF(instructionClass) { \
+    { &Assembler::encodeOperand<instructionClass, Operand::IMMED, false>, &Assembler::encodeOperand<instructionClass, Operand::IMMED, true> }, \
+    { &Assembler::encodeOperand<instructionClass, Operand::REGDIR, false>, &Assembler::encodeOperand<instructionClass, Operand::REGDIR, false> }, \
+    { &Assembler::encodeOperand<instructionClass, Operand::REGIND, false>, &Assembler::encodeOperand<instructionClass, Operand::REGIND, false> }, \
+    { &Assembler::encodeOperand<instructionClass, Operand::REGINDOFF, false>, &Assembler::encodeOperand<instructionClass, Operand::REGINDOFF, true> }, \
+    { &Assembler::encodeOperand<instructionClass, Operand::MEM, false>, &Assembler::encodeOperand<instructionClass, Operand::MEM, true> } }
+const Assembler::OperandEncoder Assembler::OPERAND_ENCODERS[3][ADDRESSING_COUNT][2] = {
+    OPERAND_ENCODERS_OF(LineRecord::BRANCH_INSTRUCTION),
+    OPERAND_ENCODERS_OF(LineRecord::ONEADDR_INSTRUCTION),
+    OPERAND_ENCODERS_OF(LineRecord::TWOADDR_INSTRUCTION)
+};
+#undef OPERAND_ENCODERS_OF
+
+// Operation code and kind of the instruction come from the lexer, so nothing is looked up by name here
+void Assembler::processInstruction(const LineRecord &record, const Operand *operands)
+{
+    constexpr int POP = instructionOperationCode("pop");
+    constexpr int XCHG = instructionOperationCode("xchg");
+    if (currentSectionNumber == -1)
+    {
+        diagnostics.error("Instruction directive must be a part of a section!");
+        return; // exit(...);
+    }
+    if (record.operationCode == -1)
+    {
+        diagnostics.error("Unknown instruction " + std::string(record.name) + "!");
+        return;
+    }
+    short data = record.operationCode << 3;
+    unsigned int numOfOperands = record.numOfOperands;
+    if (record.kind == LineRecord::NOADDR_INSTRUCTION)
+    { // Non-address instruction
+        currentSection->emitByte((char)(data & 0xFF));
+        locationCounter++;
+        return;
+    }
+    // Immediate operands are checked before anything is emitted, so an instruction which is not valid leaves no bytes behind
+    if (numOfOperands == 1 && operands[0].immediate == true && record.operationCode == POP)
+    {
+        diagnostics.error("Immediate addressing is not allowed for the destination operand!");
+        return;
+    }
+    if (numOfOperands == 2 && (operands[1].immediate == true || (operands[0].immediate == true && record.operationCode == XCHG)))
+    {
+        diagnostics.error("Immediate addressing is not allowed for the destination operand nor for the source operands if the instruction is xchg!");
+        return;
+    }
+    if (record.kind == LineRecord::TWOADDR_INSTRUCTION)
+    {
+        data |= 1; // Operands of two-address instructions are always 2 bytes
+        // OC and size byte
+        currentSection->emitByte((char)(data & 0xFF));
+        locationCounter++;
+    }
+    for (unsigned int i = 0; i < numOfOperands; i++)
+    {
+        const Operand &operand = operands[i];
+        traceOperand(operand, record.kind == LineRecord::BRANCH_INSTRUCTION);
+        (this->*OPERAND_ENCODERS[record.kind - LineRecord::BRANCH_INSTRUCTION][operand.mode][operand.isSymbol])(operand, data);
+    }
+}
+
+void Assembler::processEqu(std::string_view symbolName, std::string_view expression)
+{
+    std::vector<unsigned int> symbols;
+    std::vector<char> symbolSigns;
+    int symbolValue = 0;
+    unsigned int symbolNumber;
+    std::vector<ClassificationIndexStruct> classifictionIndexTable;
+    std::vector<std::pair<unsigned int, int>> definedSymbols; // Numbers and signs of the ones whose values were added in
+    ExpressionScanner scanner(expression);
+    char sign;
+    std::string_view currOperand;
+    while (scanner.next(sign, currOperand))
+    { // Go through the operands within the expression
+        if (currOperand[0] >= '0' && currOperand[0] <= '9')
         {
-            if (std::regex_search(operands[i], matches, LITERAL_REGEX))
+            int value = (int)literalValue(currOperand);
+            if (sign == '+')
+                symbolValue += value;
+            else
+                symbolValue -= value;       
+        }
+        else
+        { // Operand is a symbol
+            auto it = findSymbol(currOperand);
+            if (it != symbolTable.end())
             {
-                std::string literal = matches.str(2);
-                unsigned long literalValue;
-                if (std::regex_search(literal, matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                if (operands[i][0] == '$')
-                {
-                    std::cout << "One address instruction operand is an immediate value: " << matches.str(2) << "\n";
-                    if (i == 1 || (i == 0 && name == "xchg"))
-                    {
-                        std::cout << "Immediate addressing is not allowed for the destination operand nor for the source operands if the instruction is xchg!\n";
-                        return;
-                    }
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["imm"] << 5));
-                    // Operand byte(s)
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    if (literalValue > 255)
-                    {
-                        outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                        locationCounter += 3;
-                    }
+                if (it->getDefined() == true && it->getEqu() == false)
+                { // Symbol is defined -> update classification index for symbols's section and its value
+                    if (sign == '+')
+                        symbolValue += it->getSymbolValue();
                     else
-                        locationCounter += 2;
-                }
-                else
-                {
-                    std::cout << "One address instruction operand is in memory (literal stores the location): " << matches.str(2) << "\n";
-                    // Operand description byte
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                    // Operand byte(s)
-                    outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                    outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                    locationCounter += 3;
-                }
-            }
-            else if (std::regex_search(operands[i], matches, SYMBOL_REGEX))
-            {
-                if (matches.str(1) == "$")
-                {
-                    std::cout << "One address instruction operand is an immediate value (equals to the symbol's value): " << matches.str(2) << "\n";
-                    if (i == 1 || (i == 0 && name == "xchg"))
+                        symbolValue -= it->getSymbolValue();
+                    definedSymbols.push_back(std::make_pair(it->getNumber(), (sign == '+') ? 1 : -1));
+                    auto iter = classifictionIndexTable.begin();
+                    for (; iter != classifictionIndexTable.end(); iter++)
                     {
-                        std::cout << "Immediate addressing is not allowed for the destination operand nor for the source operands if the instruction is xchg!\n";
-                        return;
+                        if (iter->sectionNumber == it->getSectionNumber())
+                        {
+                            iter->classificationIndex += (sign == '+') ? 1 : -1;
+                            break;
+                        }
                     }
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["immed"] << 5));
-                }
-                else
-                {
-                    std::cout << "One address instruction operand is in memory (symbol's value is the location): " << matches.str(2) << "\n";
-                    outputFileData[currentSectionNumber].push_back((char)(addressingOperationCodes["mem"] << 5));
-                }
-                locationCounter++;
-                std::string symbolName = matches.str(2);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, symbolTable.size()));
-                    // Operand bytes
-                    outputFileData[currentSectionNumber].push_back(0);
-                    outputFileData[currentSectionNumber].push_back(0);
+                    if (iter == classifictionIndexTable.end())
+                        classifictionIndexTable.push_back(ClassificationIndexStruct(it->getSectionNumber(), (sign == '+') ? 1 : -1));
                 }
                 else
                 {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back(0);
-                        outputFileData[currentSectionNumber].push_back(0);
-                    }
-                    else // Symbol is defined
-                    {
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, RelocationTableEntry::ABSOLUTE, it->getNumber()));
-                        // Operand bytes
-                        outputFileData[currentSectionNumber].push_back((char)(it->getSymbolValue() & 0xFF));
-                        outputFileData[currentSectionNumber].push_back((char)((it->getSymbolValue() >> 8) & 0xFF));
-                    }
+                    symbols.push_back(it->getNumber());
+                    symbolSigns.push_back(sign);
                 }
-                locationCounter += 2;
             }
-            else if (std::regex_search(operands[i], matches, REGISTER_REGEX))
-            {
-                std::cout << "One address instruction operand is a register!\n";
-                if (matches.str(2)[0] == '(')
-                {
-                    std::cout << "Register indirect! Register number: " << matches.str(2)[3] << "\n";
-                    char regNum = matches.str(2)[3];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regind"] << 5) | (registerNumber << 1)));
-                }
-                else
-                {
-                    std::cout << "Register direct! Register number: " << matches.str(2)[2] << "\n";
-                    char regNum = matches.str(2)[2];
-                    int registerNumber = std::atoi(&regNum);
-                    outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regdir"] << 5) | (registerNumber << 1)));
-                }
-                locationCounter++;
+            else
+            { // Symbol is being "referenced" for the first time -> add it into the symbol table (without forward references)
+                addSymbol(SymbolTableEntry(symbolNames.intern(currOperand)));
+                symbols.push_back(symbolTable.size());
+                symbolSigns.push_back(sign);
+            }    
+        } 
+    }
+    auto it = findSymbol(symbolName);
+    if (it != symbolTable.end())
+    {
+        symbolNumber = it->getNumber();
+        if (it->getDefined() == true)
+        {
+            diagnostics.error("Multiple definitions of the symbol!");
+            return;
+        }
+        else {
+            it->setSymbolValue(symbolValue);
+            it->setEquToTrue();
+            noteValueSet(*it);
+        }
+    }
+    else
+    {
+        // Symbol is not in the symbol table -> add it...
+        addSymbol(SymbolTableEntry(symbolNames.intern(symbolName)));
+        symbolNumber = symbolTable.size();
+        symbolTable[symbolTable.size() - 1].setEquToTrue();
+        symbolTable[symbolTable.size() - 1].setSymbolValue(symbolValue);
+    }
+    for (std::pair<unsigned int, int> &symbol : definedSymbols)
+        noteValueUse(ValueUseStruct::SYMBOL, symbolNumber, symbol.first, symbol.second);
+    // Add the symbol to the EQU symbol table
+    equSymbolTable.push_back(EquTableEntry(symbolNumber, symbolSigns, symbols, classifictionIndexTable));
+}
+
+std::string_view regexGroup(const std::cmatch& matches, int group)
+{
+    if (matches[group].matched == false)
+        return std::string_view();
+    return std::string_view(matches[group].first, matches[group].length());
+}
+
+// Reference classification, done with the regexes from regexes.h; only used to validate LineLexer (searches are counted into searches)
+LineRecord classifyLineByRegexes(std::string_view line, unsigned int &searches)
+{
+    std::cmatch matches;
+    LineRecord record;
+    auto search = [&](const std::regex &regex) {
+        searches++;
+        return std::regex_search(line.data(), line.data() + line.size(), matches, regex);
+    };
+    if (search(LABEL_REGEX))
+    {
+        record.kind = LineRecord::LABEL;
+        record.name = regexGroup(matches, 1);
+    }
+    else if (search(GLOBAL_REGEX))
+    {
+        record.kind = LineRecord::GLOBAL;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(EXTERN_REGEX))
+    {
+        record.kind = LineRecord::EXTERN;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(SECTION_REGEX))
+    {
+        record.kind = LineRecord::SECTION;
+        record.name = regexGroup(matches, 1);
+    }
+    else if (search(BYTE_REGEX))
+    {
+        record.kind = LineRecord::BYTE;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(WORD_REGEX))
+    {
+        record.kind = LineRecord::WORD;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(SKIP_REGEX))
+    {
+        record.kind = LineRecord::SKIP;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(FILL_REGEX))
+    {
+        record.kind = LineRecord::FILL;
+        record.body = regexGroup(matches, 1);
+    }
+    else if (search(EQU_REGEX))
+    {
+        record.kind = LineRecord::EQU;
+        record.name = regexGroup(matches, 1);
+        record.body = regexGroup(matches, 2);
+    }
+    else if (search(NOADDR_INSTURCTION_REGEX))
+    {
+        record.kind = LineRecord::NOADDR_INSTRUCTION;
+        record.name = regexGroup(matches, 1);
+    }
+    else if (search(BRANCH_INSTRUCTION_REGEX))
+    {
+        record.kind = LineRecord::BRANCH_INSTRUCTION;
+        record.name = regexGroup(matches, 1);
+        record.operands[0] = regexGroup(matches, 2);
+        record.numOfOperands = 1;
+    }
+    else if (search(ONEADDR_INSTRUCTION_REGEX))
+    {
+        record.kind = LineRecord::ONEADDR_INSTRUCTION;
+        record.name = regexGroup(matches, 1);
+        record.operands[0] = regexGroup(matches, 2);
+        record.numOfOperands = 1;
+    }
+    else if (search(TWOADDR_INSTRUCTION_REGEX))
+    {
+        record.kind = LineRecord::TWOADDR_INSTRUCTION;
+        record.name = regexGroup(matches, 1);
+        record.operands[0] = regexGroup(matches, 2);
+        record.operands[1] = regexGroup(matches, 8);
+        record.numOfOperands = 2;
+    }
+    if (record.kind >= LineRecord::NOADDR_INSTRUCTION)
+        record.operationCode = instructionOperationCode(record.name);
+    return record;
+}
+
+void Assembler::parseLine(std::string_view line, bool validateLexer, ParsedLine &parsed)
+{
+    parsed.record = LineLexer(line).classify();
+    parsed.regexSearches = 0;
+    parsed.lexerMismatch = (validateLexer == true && classifyLineByRegexes(line, parsed.regexSearches) != parsed.record);
+    switch (parsed.record.kind)
+    {
+    case LineRecord::BRANCH_INSTRUCTION:
+    case LineRecord::ONEADDR_INSTRUCTION:
+    case LineRecord::TWOADDR_INSTRUCTION:
+        for (unsigned int i = 0; i < parsed.record.numOfOperands; i++)
+            if (decodeOperand(parsed.record.operands[i], parsed.record.kind == LineRecord::BRANCH_INSTRUCTION, parsed.operands[i]) == false)
+            { // Not accepted by the lexer either, so this can not happen; such a line is just not recognized
+                parsed.record = LineRecord();
+                break;
             }
-            else if (std::regex_search(operands[i], matches, LITREG_REGEX))
+        break;
+    default:
+        break;
+    }
+}
+
+// Parsing of a line does not depend on any other line, so chunks of lines are parsed at the same time; processing (sections, symbols,
+// location counter, emitted bytes) is then done line by line, in the original order, so the result is the same as when processing sequentially
+// Encoding stays in the sequential pass: whether a symbol operand is emitted as a value or as a forward reference depends on the symbols
+// defined before it, so chunk relative encoding would need a second kind of fix-up just to give the same bytes and relocation tables
+// The input is parsed one window of chunks at a time: while this thread processes a window, the pool's threads parse the next one into
+// the other window, so at most two windows of parsed lines are held at any time, no matter how big the input is
+void Assembler::processLinesInParallel(SourceFile &assemblyFile)
+{
+    ParseWindow windows[2];
+    unsigned int windowSize = parseThreads * CHUNKS_PER_PARSE_THREAD; // Chunks
+    bool validate = validateLexer;
+    WorkStealingPool pool(parseThreads + 1); // Worker 0 is this thread, which only helps with the first window
+    auto read = [&](ParseWindow &window) {
+        window.chunks.clear();
+        std::string_view chunk;
+        while (window.chunks.size() < windowSize && assemblyFile.nextChunk(PARSE_CHUNK_SIZE, chunk))
+            window.chunks.push_back(chunk);
+        if (window.lines.size() < window.chunks.size())
+        {
+            window.lines.resize(window.chunks.size());
+            window.parsed.resize(window.chunks.size());
+        }
+    };
+    auto parser = [&](ParseWindow &window) {
+        return [&window, validate](unsigned int, unsigned int chunk) {
+            window.lines[chunk].clear();
+            SourceFile::splitLines(window.chunks[chunk], window.lines[chunk]);
+            window.parsed[chunk].resize(window.lines[chunk].size());
+            for (unsigned int i = 0; i < window.lines[chunk].size(); i++)
+                parseLine(window.lines[chunk][i], validate, window.parsed[chunk][i]);
+        };
+    };
+    unsigned int current = 0;
+    read(windows[current]);
+    pool.run(windows[current].chunks.size(), parser(windows[current]));
+    while (windows[current].chunks.empty() == false)
+    {
+        ParseWindow &window = windows[current];
+        ParseWindow &next = windows[1 - current];
+        read(next);
+        pool.start(next.chunks.size(), parser(next));
+        for (unsigned int chunk = 0; chunk < window.chunks.size(); chunk++)
+            for (unsigned int i = 0; i < window.lines[chunk].size(); i++)
             {
-                std::cout << "One address instruction operand is a register with literal offset!\n";
-                std::cout << "Literal offset is: " << matches.str(3) << "\n";
-                std::cout << "Register number is: " << matches.str(4) << "\n";
-                std::string literal = matches.str(3);
-                int registerNumber = std::stoi(matches.str(4));
-                unsigned long literalValue;
-                if (std::regex_search(literal, matches, HEX_REGEX))
-                    literalValue = std::stoul(literal, nullptr, 16);
-                else
-                    literalValue = std::stoul(literal);
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(literalValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((literalValue >> 8) & 0xFF));
-                locationCounter += 3;
+                countParsedLine(window.parsed[chunk][i]);
+                processParsedLine(window.lines[chunk][i], window.parsed[chunk][i]);
             }
-            else if (std::regex_search(operands[i], matches, SYMREG_REGEX))
+        pool.wait();
+        current = 1 - current;
+    }
+    helperCpuSeconds += pool.getHelperCpuSeconds();
+}
+
+// Reader (splitting into lines) -> parser -> processing (this thread), each stage on its own thread; stages pass batches of lines
+// through single-producer single-consumer rings, and the time each stage spends waiting on a ring (full or empty) goes into the stats
+void Assembler::processLinesPipelined(SourceFile &assemblyFile)
+{
+    SpscRing<PipelineBatch> readLines(PIPELINE_QUEUE_SIZE);
+    SpscRing<PipelineBatch> parsedLines(PIPELINE_QUEUE_SIZE);
+    std::chrono::nanoseconds readerStall(0), parserStall(0), processingStall(0);
+    double readerCpu = 0, parserCpu = 0;
+    bool validate = validateLexer;
+    std::thread reader([&]() {
+        PipelineBatch batch;
+        std::string_view line;
+        while (assemblyFile.nextLine(line))
+        {
+            batch.lines.push_back(line);
+            if (batch.lines.size() == PIPELINE_BATCH_SIZE)
             {
-                std::cout << "One address instruction operand is a register? with symbol's value offset!\n";
-                std::cout << "Symbol is: " << matches.str(3) << "\n";
-                int registerNumber;
-                if (matches.str(4)[1] == 'p')
-                {
-                    std::cout << "PC relative!\n";
-                    registerNumber = 7;
-                }
-                else
-                {
-                    std::cout << "Register number is: " << matches.str(4)[2] << "\n";
-                    char regNum = matches.str(4)[2];
-                    registerNumber = std::atoi(&regNum);
-                }
-                // Operand description byte
-                outputFileData[currentSectionNumber].push_back((char)((addressingOperationCodes["regindoff"] << 5) | (registerNumber << 1)));
-                locationCounter++;
-                std::string symbolName = matches.str(3);
-                auto it = symbolTable.begin();
-                for (; it != symbolTable.end(); it++)
-                    if (it->getSymbolName() == symbolName)
-                        break;
-                RelocationTableEntry::Type type = (registerNumber == 7) ? RelocationTableEntry::RELATIVE : RelocationTableEntry::ABSOLUTE;
-                int dataValue = (registerNumber == 7) ? -2 : 0;
-                if (it == symbolTable.end())
-                { // Symbol has not yet been defined/referenced
-                    symbolTable.push_back(SymbolTableEntry(symbolName, ForwardReferenceStruct(locationCounter, currentSectionNumber)));
-                    if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                        sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, symbolTable.size())})}});
-                    else
-                        sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, symbolTable.size()));
-                }
-                else
-                {
-                    if (it->getDefined() == false)
-                    {
-                        it->addForwardReference(ForwardReferenceStruct(locationCounter, currentSectionNumber));
-                        if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                            sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                        else
-                            sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                    }
-                    else // Symbol is defined
-                    {
-                        if (it->getSymbolScope() == SymbolTableEntry::LOCAL)
-                        {
-                            if (currentSectionNumber == it->getSectionNumber() && registerNumber == 7) // Constant offset - no relocation data needed
-                                dataValue = it->getSymbolValue() - locationCounter - 2;
-                            else
-                            { // Relocation data is needed
-                                dataValue += it->getSymbolValue();
-                                if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                    sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                                else
-                                    sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                            }
-                        }
-                        else if (it->getSymbolScope() == SymbolTableEntry::GLOBAL)
-                        {
-                            if (sectionRelocationTables.find(currentSectionNumber) == sectionRelocationTables.end())
-                                sectionRelocationTables.insert({{currentSectionNumber, std::vector<RelocationTableEntry>({RelocationTableEntry(locationCounter, type, it->getNumber())})}});
-                            else
-                                sectionRelocationTables[currentSectionNumber].push_back(RelocationTableEntry(locationCounter, type, it->getNumber()));
-                        }
-                    }
-                }
-                // Operand bytes
-                outputFileData[currentSectionNumber].push_back((char)(dataValue & 0xFF));
-                outputFileData[currentSectionNumber].push_back((char)((dataValue >> 8) & 0xFF));
-                locationCounter += 2;
+                readLines.push(batch, readerStall);
+                batch = PipelineBatch();
             }
         }
+        batch.last = true;
+        readLines.push(batch, readerStall);
+        readerCpu = threadCpuSeconds();
+    });
+    std::thread parser([&]() {
+        bool last = false;
+        while (last == false)
+        {
+            PipelineBatch batch;
+            readLines.pop(batch, parserStall);
+            batch.parsed.resize(batch.lines.size());
+            for (unsigned int i = 0; i < batch.lines.size(); i++)
+                parseLine(batch.lines[i], validate, batch.parsed[i]);
+            last = batch.last;
+            parsedLines.push(batch, parserStall);
+        }
+        parserCpu = threadCpuSeconds();
+    });
+    bool last = false;
+    while (last == false)
+    {
+        PipelineBatch batch;
+        parsedLines.pop(batch, processingStall);
+        for (unsigned int i = 0; i < batch.lines.size(); i++)
+        {
+            countParsedLine(batch.parsed[i]);
+            processParsedLine(batch.lines[i], batch.parsed[i]);
+        }
+        last = batch.last;
     }
+    reader.join();
+    parser.join();
+    helperCpuSeconds += readerCpu + parserCpu;
+    stats.readerStallSeconds += std::chrono::duration<double>(readerStall).count();
+    stats.parserStallSeconds += std::chrono::duration<double>(parserStall).count();
+    stats.processingStallSeconds += std::chrono::duration<double>(processingStall).count();
 }
 
-void processEqu(std::string& symbolName, std::vector<std::string>& exprOperands, std::vector<std::string>& operandSigns)
+// Whether the line is a .section directive (or a malformed one); decided without classifying the whole line
+bool startsSection(std::string_view line)
 {
-    std::vector<unsigned int> symbols;
-    std::vector<char> symbolSigns;
-    unsigned int size = exprOperands.size();
-    int symbolValue = 0;
-    unsigned int symbolNumber;
-    std::vector<ClassificationIndexStruct> classifictionIndexTable;
-    for (int i = 0; i < size; i++)
-    { // Go through the operands within the expression
-        std::smatch matches;
-        std::string currOperand = exprOperands[i];
-        if (std::regex_search(currOperand, matches, LITERAL_REGEX))
+    size_t position = line.find_first_not_of(" \t\n\v\f\r");
+    return position != std::string_view::npos && line.substr(position, 8) == ".section";
+}
+
+// Lines are taken in blocks: a .section directive is always processed on its own, and the lines in between are split into blocks after
+// the lines which are picked by their own text, so inserting or removing a line only changes the block it is in. A block which was seen
+// before is replayed from the cache if it is in the same section, and the symbols it uses are of the same kind, section and scope as back
+// then (so they are encoded the same way); a block may start elsewhere in the section and the symbols may have other values, as whatever
+// was worked out from those is patched on replay. So an edit which changes the size of a block only has that block encoded again, unless
+// it adds symbols (which moves the numbers of the symbols added after it). Only the blocks which do not replay are parsed and encoded again
+// Patching of the forward references and relocation data is done on the whole tables afterwards, the same way as without the cache
+void Assembler::processLinesIncrementally(SourceFile &assemblyFile)
+{
+    cacheGeneration++;
+    std::vector<std::string_view> lines; // Of the current block
+    std::string_view line;
+    while (assemblyFile.nextLine(line))
+    {
+        lineCount++;
+        if (startsSection(line) == true)
         {
-            int literalValue;
-            if (std::regex_search(currOperand, matches, HEX_REGEX))
-                literalValue = std::stoi(currOperand, nullptr, 16);
-            else
-                literalValue = std::stoi(currOperand);
-            if (operandSigns[i] == "+")
-                symbolValue += literalValue;
-            else
-                symbolValue -= literalValue;       
+            processBlock(lines);
+            lines.clear();
+            processLine(line);
+            encodedLineCount++;
+            continue;
+        }
+        lines.push_back(line);
+        if (lines.size() == MAX_BLOCK_LINES || (line.empty() == false && std::hash<std::string_view>()(line) % BLOCK_BOUNDARY_LINES == 0))
+        {
+            processBlock(lines);
+            lines.clear();
         }
+    }
+    processBlock(lines);
+    for (auto it = blockCache.begin(); it != blockCache.end(); )
+    { // Blocks which were not used by this assembly are dropped
+        std::vector<CachedBlock> &blocks = it->second;
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [this](const CachedBlock &block) {
+            return block.generation != cacheGeneration;
+        }), blocks.end());
+        if (blocks.empty() == true)
+            it = blockCache.erase(it);
         else
-        { // Operand is a symbol
-            auto it = symbolTable.begin();
-            for (; it != symbolTable.end(); it++)
-            {
-                if (it->getSymbolName() == currOperand)
-                {
-                    if (it->getDefined() == true && it->getEqu() == false)
-                    { // Symbol is defined -> update classification index for symbols's section and its value
-                        if (operandSigns[i] == "+")
-                            symbolValue += it->getSymbolValue();
-                        else
-                            symbolValue -= it->getSymbolValue();
-                        auto iter = classifictionIndexTable.begin();
-                        for (; iter != classifictionIndexTable.end(); iter++)
-                        {
-                            if (iter->sectionNumber == it->getSectionNumber())
-                            {
-                                iter->classificationIndex += (operandSigns[i] == "+") ? 1 : -1;
-                                break;
-                            }
-                        }
-                        if (iter == classifictionIndexTable.end())
-                            classifictionIndexTable.push_back(ClassificationIndexStruct(it->getSectionNumber(), (operandSigns[i] == "+") ? 1 : -1));
-                    }
-                    else
-                    {
-                        symbols.push_back(it->getNumber());
-                        symbolSigns.push_back(operandSigns[i][0]);
-                    }
-                    break;
-                }
-            }
-            if (it == symbolTable.end())
-            { // Symbol is being "referenced" for the first time -> add it into the symbol table (without forward references)
-                symbolTable.push_back(SymbolTableEntry(currOperand));
-                symbols.push_back(symbolTable.size());
-                symbolSigns.push_back(operandSigns[i][0]);
-            }    
-        } 
+            it++;
     }
-    auto it = symbolTable.begin();
-    for (; it != symbolTable.end(); it++)
-    {
-        if (it->getSymbolName() == symbolName)
-        {
-            symbolNumber = it->getNumber();
-            if (it->getDefined() == true)
+}
+
+void Assembler::processBlock(const std::vector<std::string_view> &lines)
+{
+    if (lines.empty() == true)
+        return;
+    const char *start = lines.front().data();
+    cacheKey.assign(start, lines.back().data() + lines.back().size() - start);
+    std::vector<CachedBlock> &blocks = blockCache[cacheKey];
+    if (diagnostics.tracing() == false) // Trace messages describe each line as it is processed, so nothing is replayed while tracing
+        for (CachedBlock &block : blocks)
+            if (block.lineCount == lines.size() && replayBlock(block) == true)
             {
-                std::cout << "Multiple definitions of the symbol!\n";
+                block.generation = cacheGeneration;
                 return;
             }
-            else {
-                it->setSymbolValue(symbolValue);
-                it->setEquToTrue();
-            }
-            break;
+    CachedBlock block;
+    recordBlock(lines, block);
+    if (block.generation == 0)
+        return; // Reported an error or a warning, which would not be reported again when replaying
+    for (CachedBlock &previous : blocks)
+        if (previous.generation != cacheGeneration)
+        { // Some other state of the same lines, which was not used by this assembly
+            previous = std::move(block);
+            return;
         }
+    blocks.push_back(std::move(block));
+}
+
+// Applies what the block did, if it starts from the same state as when it was recorded, apart from where the block starts and the values
+// of the symbols; returns false (changing nothing) otherwise. Whatever was worked out from those values is patched by how much they moved
+bool Assembler::replayBlock(CachedBlock &block)
+{
+    if (block.sectionNumber != currentSectionNumber)
+        return false;
+    if (block.addedSymbols.empty() == false && block.symbolCount != symbolTable.size())
+        return false; // Numbers of the added symbols would not be the same
+    for (BlockSymbolStruct &symbol : block.usedSymbols)
+    {
+        if (symbol.before.getNumber() > symbolTable.size())
+            return false;
+        SymbolTableEntry &current = symbolTable[symbol.before.getNumber() - 1];
+        if (current.sameAs(symbol.before) == false || symbolNames.getName(current.getNameId()) != symbol.name)
+            return false;
     }
-    if (it == symbolTable.end())
+    for (std::pair<std::string, SymbolTableEntry> &symbol : block.addedSymbols)
+        if (findSymbol(symbol.first) != symbolTable.end())
+            return false;
+    for (BlockSymbolStruct &symbol : block.usedSymbols)
     {
-        // Symbol is not in the symbol table -> add it...
-        symbolTable.push_back(SymbolTableEntry(symbolName));
-        symbolNumber = symbolTable.size();
-        symbolTable[symbolTable.size() - 1].setEquToTrue();
-        symbolTable[symbolTable.size() - 1].setSymbolValue(symbolValue);
+        SymbolTableEntry &current = symbolTable[symbol.before.getNumber() - 1];
+        int value = current.getSymbolValue();
+        current.copyStateFrom(symbol.after);
+        if (symbol.valueSet == false)
+            current.setSymbolValue(value);
     }
-    // Add the symbol to the EQU symbol table
-    equSymbolTable.push_back(EquTableEntry(symbolNumber, symbolSigns, symbols, classifictionIndexTable));
+    for (std::pair<std::string, SymbolTableEntry> &symbol : block.addedSymbols)
+    {
+        SymbolTableEntry entry(symbolNames.intern(symbol.first));
+        entry.copyStateFrom(symbol.second);
+        addSymbol(entry);
+    }
+    if (currentSection != nullptr)
+        currentSection->append(block.contents);
+    for (ForwardReferenceStruct forwardReference : block.forwardReferences)
+    {
+        forwardReference.patch += locationCounter;
+        forwardReferences.push_back(forwardReference);
+    }
+    equSymbolTable.insert(equSymbolTable.end(), block.equSymbols.begin(), block.equSymbols.end());
+    // Labels move with the start of the block first, as the other values may have been worked out from them
+    for (unsigned int pass = 0; pass < 2; pass++)
+        for (ValueUseStruct &use : block.valueUses)
+        {
+            if ((use.source == 0) != (pass == 0))
+                continue;
+            int current = (use.source == 0) ? (int)locationCounter : symbolTable[use.source - 1].getSymbolValue();
+            int change = use.sign * (current - use.value);
+            if (change == 0)
+                continue;
+            if (use.target == ValueUseStruct::SYMBOL)
+                symbolTable[use.position - 1].setSymbolValue(symbolTable[use.position - 1].getSymbolValue() + change);
+            else if (use.target == ValueUseStruct::WORD)
+                currentSection->addToWord(locationCounter + use.position, change);
+            else
+                currentSection->addToByte(locationCounter + use.position, change);
+        }
+    locationCounter += block.size;
+    for (unsigned int kind = 0; kind <= LineRecord::TWOADDR_INSTRUCTION; kind++)
+        stats.lines[kind] += block.lines[kind];
+    currentLine += block.lineCount;
+    return true;
+}
+
+// Processes the lines of the block, and records what they did into it; generation of the block is left at 0 if any message was reported
+void Assembler::recordBlock(const std::vector<std::string_view> &lines, CachedBlock &block)
+{
+    block.lineCount = lines.size();
+    block.sectionNumber = currentSectionNumber;
+    block.locationCounter = locationCounter;
+    block.symbolCount = symbolTable.size();
+    StatsStruct start = stats;
+    unsigned int forwardReferenceCount = forwardReferences.size();
+    unsigned int equSymbolCount = equSymbolTable.size();
+    unsigned int reportCount = diagnostics.getReportCount();
+    Section::Mark mark;
+    if (currentSection != nullptr)
+        mark = currentSection->mark();
+    blockSerial++;
+    if (symbolUseMarks.size() < symbolTable.size())
+        symbolUseMarks.resize(symbolTable.size(), 0);
+    recordedBlock = &block;
+    for (std::string_view line : lines)
+        processLine(line);
+    recordedBlock = nullptr;
+    encodedLineCount += lines.size();
+    if (diagnostics.getReportCount() != reportCount)
+        return;
+    for (unsigned int kind = 0; kind <= LineRecord::TWOADDR_INSTRUCTION; kind++)
+        block.lines[kind] = stats.lines[kind] - start.lines[kind];
+    for (BlockSymbolStruct &symbol : block.usedSymbols)
+        symbol.after = symbolTable[symbol.before.getNumber() - 1];
+    for (unsigned int i = block.symbolCount; i < symbolTable.size(); i++)
+        block.addedSymbols.push_back(std::make_pair(std::string(symbolNames.getName(symbolTable[i].getNameId())), symbolTable[i]));
+    if (currentSection != nullptr)
+        currentSection->copySince(mark, block.contents);
+    block.forwardReferences.assign(forwardReferences.begin() + forwardReferenceCount, forwardReferences.end());
+    for (ForwardReferenceStruct &forwardReference : block.forwardReferences)
+        forwardReference.patch -= block.locationCounter;
+    block.equSymbols.assign(equSymbolTable.begin() + equSymbolCount, equSymbolTable.end());
+    block.size = locationCounter - block.locationCounter;
+    block.generation = cacheGeneration;
+}
+
+// Symbol which the block being recorded uses; only its first use counts, and only if the symbol was there before the block
+void Assembler::noteUsedSymbol(SymbolTableEntry &symbol)
+{
+    unsigned int number = symbol.getNumber();
+    if (number > recordedBlock->symbolCount || symbolUseMarks[number - 1] == blockSerial)
+        return;
+    symbolUseMarks[number - 1] = blockSerial;
+    recordedBlock->usedSymbols.push_back(BlockSymbolStruct(std::string(symbolNames.getName(symbol.getNameId())), symbol));
+}
+
+// Word or byte at the position (an offset within the current section), or value of the symbol (by number), which the block being recorded
+// worked out from the value of the source symbol (or from the location counter at the start of the block, if the source is 0)
+void Assembler::noteValueUse(ValueUseStruct::Target target, unsigned int position, unsigned int source, int sign)
+{
+    if (recordedBlock == nullptr)
+        return;
+    if (target != ValueUseStruct::SYMBOL)
+        position -= recordedBlock->locationCounter;
+    int value = (source == 0) ? (int)recordedBlock->locationCounter : symbolTable[source - 1].getSymbolValue();
+    recordedBlock->valueUses.push_back(ValueUseStruct(target, position, source, sign, value));
+}
+
+// Symbol whose value the block being recorded sets (by a label or an EQU)
+void Assembler::noteValueSet(SymbolTableEntry &symbol)
+{
+    if (recordedBlock == nullptr || symbol.getNumber() > recordedBlock->symbolCount)
+        return; // Added symbols are replayed as they were left anyway
+    for (auto it = recordedBlock->usedSymbols.rbegin(); it != recordedBlock->usedSymbols.rend(); it++)
+        if (it->before.getNumber() == symbol.getNumber())
+        {
+            it->valueSet = true;
+            return;
+        }
+}
+
+void Assembler::processLine(std::string_view line)
+{
+    ParsedLine parsed;
+    parseLine(line, validateLexer, parsed);
+    countParsedLine(parsed);
+    processParsedLine(line, parsed);
 }
 
-void processLine(std::string line)
+void Assembler::processParsedLine(std::string_view line, const ParsedLine &parsed)
 {
-    std::smatch matches;
-    std::smatch matchesOperand;
-    if (std::regex_search(line, matches, LABEL_REGEX))
+    const LineRecord &record = parsed.record;
+    stats.lines[record.kind]++;
+    diagnostics.setLine(++currentLine);
+    if (parsed.lexerMismatch == true)
+        diagnostics.warning("Lexer and reference regexes classify the line differently: " + std::string(line));
+    switch (record.kind)
+    {
+    case LineRecord::LABEL:
     { // Is it a label?
-        std::cout << "Found a label!\n";
-        std::cout << "Label name: " << matches.str(1) << "\n";
+        TRACE("Found a label!\n");
+        TRACE("Label name: " << record.name << "\n");
         if (currentSectionNumber == -1)
         { // Label must be a part of a section!
-            std::cout << "Label must be a part of a section!\n";
+            diagnostics.error("Label must be a part of a section!");
             // exit(1);
         }
         else
         {
-            std::string labelName = matches.str(1);
-            processLabelDefinition(labelName);
+            processLabelDefinition(record.name);
         }
+        break;
     }
-    else if (std::regex_search(line, matches, GLOBAL_REGEX))
-    { // Is it a global?
-        std::cout << "Found a global!\n";
-        std::cout << "List of global symbols: " << matches.str(1) << "\n";
-        std::string symbolList = matches.str(1);
-        symbolList.erase(std::remove(symbolList.begin(), symbolList.end(), ' '), symbolList.end()); // Remove all spaces
-        while (std::regex_search(symbolList, matches, LIST_REGEX))
+    case LineRecord::GLOBAL:
+    case LineRecord::EXTERN:
+    { // Is it a global/an extern?
+        bool isExtern = (record.kind == LineRecord::EXTERN);
+        if (isExtern)
         {
-            std::string symbolName = matches.str(1);
-            processGlobal(symbolName, false);
-            symbolList = matches.suffix();
+            TRACE("Found an extern!\n");
+            TRACE("List of extern symbols: " << record.body << "\n");
         }
-    }
-    else if (std::regex_search(line, matches, EXTERN_REGEX))
-    { // Is it an extern?
-        std::cout << "Found an extern!\n";
-        std::cout << "List of extern symbols: " << matches.str(1) << "\n";
-        std::string symbolList = matches.str(1);
-        symbolList.erase(std::remove(symbolList.begin(), symbolList.end(), ' '), symbolList.end()); // Remove all spaces
-        while (std::regex_search(symbolList, matches, LIST_REGEX))
+        else
         {
-            std::string symbolName = matches.str(1);
-            processGlobal(symbolName, true);
-            symbolList = matches.suffix();
+            TRACE("Found a global!\n");
+            TRACE("List of global symbols: " << record.body << "\n");
         }
+        ListScanner scanner(record.body);
+        std::string_view symbol;
+        while (scanner.next(symbol))
+            processGlobal(symbol, isExtern);
+        break;
     }
-    else if (std::regex_search(line, matches, SECTION_REGEX))
+    case LineRecord::SECTION:
     { // Is it a section?
-        std::cout << "Found a section!\n";
-        std::cout << "Section name: " << matches.str(1) << "\n";
-        std::string sectionName = matches.str(1);
-        processSection(sectionName);
-    }
-    else if (std::regex_search(line, matches, BYTE_REGEX))
-    { // Is it a byte?
-        std::cout << "Found a byte!\n";
-        std::cout << "List of symbols/literals: " << matches.str(1) << "\n";
+        TRACE("Found a section!\n");
+        TRACE("Section name: " << record.name << "\n");
+        processSection(record.name);
+        break;
+    }
+    case LineRecord::BYTE:
+    case LineRecord::WORD:
+    { // Is it a byte/a word?
+        TRACE(((record.kind == LineRecord::BYTE) ? "Found a byte!\n" : "Found a word!\n"));
+        TRACE("List of symbols/literals: " << record.body << "\n");
         if (currentSectionNumber == -1)
         {
-            std::cout << "Memory allocation directive must be a part of a section!\n";
+            diagnostics.error("Memory allocation directive must be a part of a section!");
             // exit(1);
         }
         else
-        {
-            std::string symbolList = matches.str(1);
-            symbolList.erase(std::remove(symbolList.begin(), symbolList.end(), ' '), symbolList.end()); // Remove all spaces
-            std::vector<std::string> symbols;
-            while (std::regex_search(symbolList, matches, LIST_REGEX))
-            {
-                symbols.push_back(matches.str(1));
-                symbolList = matches.suffix();
-            }
-            processMemoryAllocation(1, symbols);
-        }
+            processMemoryAllocation((record.kind == LineRecord::BYTE) ? 1 : 2, record.body);
+        break;
     }
-    else if (std::regex_search(line, matches, WORD_REGEX))
-    { // Is it a word?
-        std::cout << "Found a word!\n";
-        std::cout << "List of symbols/literals: " << matches.str(1) << "\n";
+    case LineRecord::SKIP:
+    { // Is it a skip?
+        TRACE("Found a skip!\n");
+        TRACE("Literal: " << record.body << "\n");
         if (currentSectionNumber == -1)
         {
-            std::cout << "Memory allocation directive must be a part of a section!\n";
+            diagnostics.error("Memory allocation directive must be a part of a section!");
             // exit(1);
         }
         else
-        {
-            std::string symbolList = matches.str(1);
-            symbolList.erase(std::remove(symbolList.begin(), symbolList.end(), ' '), symbolList.end()); // Remove all spaces
-            std::vector<std::string> symbols;
-            while (std::regex_search(symbolList, matches, LIST_REGEX))
-            {
-                symbols.push_back(matches.str(1));
-                symbolList = matches.suffix();
-            }
-            processMemoryAllocation(2, symbols);
-        }
+            processMemoryAllocation(3, record.body);
+        break;
     }
-    else if (std::regex_search(line, matches, SKIP_REGEX))
-    { // Is it a skip?
-        std::cout << "Found a skip!\n";
-        std::cout << "Literal: " << matches.str(1) << "\n";
+    case LineRecord::FILL:
+    { // Is it a fill?
+        TRACE("Found a fill!\n");
+        TRACE("Literals: " << record.body << "\n");
         if (currentSectionNumber == -1)
-        {
-            std::cout << "Memory allocation directive must be a part of a section!\n";
-            // exit(1);
-        }
+            diagnostics.error("Memory allocation directive must be a part of a section!");
         else
-        {
-            std::vector<std::string> symbols;
-            symbols.push_back(matches.str(1));
-            processMemoryAllocation(3, symbols);
-        }
+            processMemoryAllocation(4, record.body);
+        break;
     }
-    else if (std::regex_search(line, matches, EQU_REGEX))
+    case LineRecord::EQU:
     { // Is it an equ?
-        std::cout << "Found an equ!\n";
-        std::cout << "Symbol name: " << matches.str(1) << "\n";
-        std::string symbolName = matches.str(1);
-        std::cout << "Expression: " << matches.str(2) << "\n";
-        std::string expression = matches.str(2);
-        expression.erase(std::remove(expression.begin(), expression.end(), ' '), expression.end()); // Remove all spaces
-        std::vector<std::string> exprOperands;
-        std::vector<std::string> operandSigns({ "+" });
-        while (std::regex_search(expression, matches, EXPRESSION_REGEX))
-        {
-            exprOperands.push_back(matches.str(1));
-            if (matches.str(2) != "")
-                operandSigns.push_back(matches.str(2));
-            expression = matches.suffix();
-        }
-        processEqu(symbolName, exprOperands, operandSigns);
+        TRACE("Found an equ!\n");
+        TRACE("Symbol name: " << record.name << "\n");
+        TRACE("Expression: " << record.body << "\n");
+        processEqu(record.name, record.body);
+        break;
     }
-    else
-    { // Is it an instruction or an error?
-        if (std::regex_search(line, matches, NOADDR_INSTURCTION_REGEX))
-        { // Is it a non-address instruction?
-            std::cout << "Non-address instruction name: " << matches.str(1) << "\n";
-            std::string instructionName = matches.str(1);
-            processInstruction(instructionName, std::vector<std::string>());
-        }
-        else if (std::regex_search(line, matches, BRANCH_INSTRUCTION_REGEX))
-        { // Is it a branch instruction?
-            std::cout << "Branch instruction name: " << matches.str(1) << "\n";
-            std::cout << "Branch instruction operand: " << matches.str(2) << "\n";
-            std::string instructionName = matches.str(1);
-            std::string operand = matches.str(2);
-            processInstruction(instructionName, std::vector<std::string>({operand}), true);
-        }
-        else if (std::regex_search(line, matches, ONEADDR_INSTRUCTION_REGEX))
-        {
-            std::cout << "One operand instruction name: " << matches.str(1) << "\n";
-            std::cout << "One operand instruction operand: " << matches.str(2) << "\n";
-            std::string instructionName = matches.str(1);
-            std::string operand = matches.str(2);
-            processInstruction(instructionName, std::vector<std::string>({operand}));
-        }
-        else if (std::regex_search(line, matches, TWOADDR_INSTRUCTION_REGEX))
-        {
-            std::cout << "Two operand instruction name: " << matches.str(1) << "\n";
-            std::cout << "Two operand instruction operand #1: " << matches.str(2) << "\n";
-            std::cout << "Two operand instruction operand #2: " << matches.str(8) << "\n";
-            std::string instructionName = matches.str(1);
-            std::string operand1 = matches.str(2);
-            std::string operand2 = matches.str(8);
-            processInstruction(instructionName, std::vector<std::string>({operand1, operand2}));
-        }
+    case LineRecord::NOADDR_INSTRUCTION:
+    { // Is it a non-address instruction?
+        TRACE("Non-address instruction name: " << record.name << "\n");
+        processInstruction(record, parsed.operands);
+        break;
+    }
+    case LineRecord::BRANCH_INSTRUCTION:
+    { // Is it a branch instruction?
+        TRACE("Branch instruction name: " << record.name << "\n");
+        TRACE("Branch instruction operand: " << record.operands[0] << "\n");
+        processInstruction(record, parsed.operands);
+        break;
+    }
+    case LineRecord::ONEADDR_INSTRUCTION:
+    {
+        TRACE("One operand instruction name: " << record.name << "\n");
+        TRACE("One operand instruction operand: " << record.operands[0] << "\n");
+        processInstruction(record, parsed.operands);
+        break;
+    }
+    case LineRecord::TWOADDR_INSTRUCTION:
+    {
+        TRACE("Two operand instruction name: " << record.name << "\n");
+        TRACE("Two operand instruction operand #1: " << record.operands[0] << "\n");
+        TRACE("Two operand instruction operand #2: " << record.operands[1] << "\n");
+        processInstruction(record, parsed.operands);
+        break;
+    }
+    default: // Neither a directive nor an instruction
+        break;
+    }
+}
+
+// Adds the symbols' values on all of the forward referenced words, either for the EQU symbols or for all of the other (non-extern) ones
+// References are sorted by section and offset, so this is a single pass through each section's contents
+void Assembler::patchForwardReferences(bool equSymbols)
+{
+    Section *section = nullptr;
+    for (ForwardReferenceStruct &reference : forwardReferences)
+    {
+        SymbolTableEntry &symbol = symbolTable[reference.symbolNumber - 1];
+        if (symbol.getEqu() != equSymbols || (equSymbols == false && symbol.getSymbolScope() == SymbolTableEntry::EXTERN)) continue;
+        if (section == nullptr || section->getSectionNumber() != reference.sectionNumber)
+            section = getSection(reference.sectionNumber);
+        int symbolValue = symbol.getSymbolValue();
+        section->addToWord(reference.patch, (reference.sign == '+') ? symbolValue : -symbolValue);
+        stats.patchedForwardReferences++;
     }
 }
 
-void processNonEquForwardReferences()
+void Assembler::processNonEquForwardReferences()
 {
     auto it = symbolTable.begin();
     for (; it != symbolTable.end(); it++)
-    {
-        if (it->getEqu() == true || it->getSymbolScope() == SymbolTableEntry::EXTERN) continue;
-        if (it->getDefined() == false)
+        if (it->getEqu() == false && it->getSymbolScope() != SymbolTableEntry::EXTERN && it->getDefined() == false)
         {
-            std::cout << "Non-equ and non-extern symbol is not defined!\n";
+            diagnostics.error("Non-equ and non-extern symbol is not defined!");
             return; // Error - non-equ and non-extern symbol is not defined
         }
-        std::list<ForwardReferenceStruct> forwardReferences = it->getFowardsReferences();
-        auto iter = forwardReferences.begin();
-        for (; iter != forwardReferences.end(); iter++)
+    std::sort(forwardReferences.begin(), forwardReferences.end(), [](const ForwardReferenceStruct &first, const ForwardReferenceStruct &second) {
+        return (first.sectionNumber != second.sectionNumber) ? first.sectionNumber < second.sectionNumber : first.patch < second.patch;
+    });
+    patchForwardReferences(false);
+    // Each relocation is looked at once: its symbol is found by number, and the entries which are no longer needed are compacted away
+    for (Section &section : sections)
+    {
+        std::vector<RelocationTableEntry> &relocationTable = section.getRelocationTable();
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < relocationTable.size(); i++)
         {
-            char lowerByte = (char)(outputFileData[iter->sectionNumber][iter->patch] & 0xFF);
-            char higherByte = (char)(outputFileData[iter->sectionNumber][iter->patch + 1] & 0xFF);
-            int dataValue = lowerByte | (higherByte << 8);
-            int symbolValue = it->getSymbolValue();
-            dataValue += (iter->sign == '+') ? symbolValue : -symbolValue;
-            // Get the new value back in the file
-            outputFileData[iter->sectionNumber][iter->patch] = (char)(dataValue & 0xFF);
-            outputFileData[iter->sectionNumber][iter->patch + 1] = (char)((dataValue >> 8) & 0xFF);
+            RelocationTableEntry &relocation = relocationTable[i];
+            SymbolTableEntry &symbol = symbolTable[relocation.getSymbolNumber() - 1];
+            bool isSection = (symbol.getNumber() == symbol.getSectionNumber());
+            if (symbol.getEqu() == false && symbol.getSymbolScope() == SymbolTableEntry::LOCAL && isSection == false)
+            { // Relocation data for a local symbol is changed to be for its section
+                if (relocation.getType() == RelocationTableEntry::RELATIVE && section.getSectionNumber() == symbol.getSectionNumber())
+                { // PC relative relocation data within the same section - no relocation data is needed
+                    section.addToWord(relocation.getOffset(), -(int)relocation.getOffset());
+                    continue;
+                }
+                relocation.setSymbolNumber(symbol.getSectionNumber());
+            }
+            relocationTable[kept++] = relocation;
         }
-        if (it->getNumber() == it->getSectionNumber() || it->getSymbolScope() != SymbolTableEntry::LOCAL) continue; // Symbol is a section, or it is a global/extern symbol
-        // Update all of the relocation data for the symbol
-        auto iterator = sectionRelocationTables.begin();
-        for (; iterator != sectionRelocationTables.end(); iterator++)
+        relocationTable.erase(relocationTable.begin() + kept, relocationTable.end());
+    }
+}
+
+// Cycle of EQU symbols which the unresolved EQU symbol is a part of, or depends on, as "a -> b -> a"
+// Each EQU symbol of the cycle gets marked in reported; an empty string is returned for a cycle which is already reported
+std::string Assembler::describeEquCycle(unsigned int equPosition, const std::vector<unsigned int> &pending, std::vector<bool> &reported)
+{
+    std::vector<int> pathPosition(equSymbolTable.size(), -1);
+    std::vector<unsigned int> path;
+    unsigned int current = equPosition;
+    while (pathPosition[current] == -1)
+    { // An unresolved EQU symbol always has at least one unresolved EQU dependency to continue with
+        pathPosition[current] = path.size();
+        path.push_back(current);
+        for (unsigned int dependency : equSymbolTable[current].getSymbolDependencies())
         {
-            for (int i = 0; i < iterator->second.size(); i++)
+            int position = equSymbolIndex[dependency];
+            if (position != -1 && pending[position] > 0)
             {
-                if (iterator->second[i].getSymbolNumber() != it->getNumber()) continue;
-                int num = it->getNumber();
-                // Relocation data is for the current symbol
-                if (iterator->second[i].getType() == RelocationTableEntry::ABSOLUTE)
-                    iterator->second[i].setSymbolNumber(it->getSectionNumber()); // Relocation data 
-                else 
-                { // PC relative relocation data
-                    if (iterator->first == it->getSectionNumber()) 
-                    { // No relocation data is needed
-                        char lowerByte = (char)(outputFileData[iterator->first][iterator->second[i].getOffset()] & 0xFF);
-                        char higherByte = (char)(outputFileData[iterator->first][iterator->second[i].getOffset() + 1] & 0xFF);
-                        int dataValue = lowerByte | (higherByte << 8);
-                        dataValue -= iterator->second[i].getOffset();
-                        outputFileData[iterator->first][iterator->second[i].getOffset()] = (char)(dataValue & 0xFF);
-                        outputFileData[iterator->first][iterator->second[i].getOffset() + 1] = (char)((dataValue >> 8) & 0xFF);
-                        iterator->second.erase(iterator->second.begin() + i);
-                        i--;
-                    }
-                    else
-                        iterator->second[i].setSymbolNumber(it->getSectionNumber());
-                }
+                current = position;
+                break;
             }
         }
-        it->resetForwardRefernces();
     }
+    if (reported[current] == true) return std::string();
+    std::string cycle;
+    for (unsigned int i = pathPosition[current]; i < path.size(); i++)
+    {
+        reported[path[i]] = true;
+        cycle += std::string(symbolNames.getName(symbolTable[equSymbolTable[path[i]].getSymbolNumber() - 1].getNameId())) + " -> ";
+    }
+    return cycle + std::string(symbolNames.getName(symbolTable[equSymbolTable[current].getSymbolNumber() - 1].getNameId()));
 }
 
-void processEquValue1()
-{ // Updating EQU symbol values, based off of only non-EQU symbols
-    auto it = equSymbolTable.begin();
-    for (; it != equSymbolTable.end(); it++)
-    {
-        std::vector<unsigned int> symbolDependencies = it->getSymbolDependencies();
-        std::vector<char> symbolSigns = it->getSymbolSigns();
-        int equSymbolValue = symbolTable[it->getSymbolNumber() - 1].getSymbolValue();
-        int size = symbolDependencies.size();
-        for (int i = 0; i < size; i++)
+void Assembler::processEquValues()
+{ // Updating EQU symbol values in dependency order: an EQU symbol gets resolved once all of the EQU symbols within its expression are resolved
+    unsigned int count = equSymbolTable.size();
+    equSymbolIndex.assign(symbolTable.size() + 1, -1);
+    for (unsigned int i = 0; i < count; i++)
+        equSymbolIndex[equSymbolTable[i].getSymbolNumber()] = i;
+    std::vector<unsigned int> pending(count, 0); // Number of the EQU symbol's dependencies which are not yet resolved
+    std::vector<std::vector<EquDependentStruct>> dependents(count);
+    std::vector<unsigned int> resolved; // Also used as the queue of EQU symbols which are ready to be resolved
+    resolved.reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+    { // Non-EQU symbols are all known by now, so they are accounted for right away
+        EquTableEntry &equSymbol = equSymbolTable[i];
+        SymbolTableEntry &symbol = symbolTable[equSymbol.getSymbolNumber() - 1];
+        const std::vector<unsigned int> &symbolDependencies = equSymbol.getSymbolDependencies();
+        const std::vector<char> &symbolSigns = equSymbol.getSymbolSigns();
+        int equSymbolValue = symbol.getSymbolValue();
+        for (unsigned int j = 0; j < symbolDependencies.size(); j++)
         {
-            if (symbolTable[symbolDependencies[i] - 1].getEqu() == false)
+            int position = equSymbolIndex[symbolDependencies[j]];
+            if (position == -1)
             {
-                int symbolValue = symbolTable[symbolDependencies[i] - 1].getSymbolValue();
-                equSymbolValue += (symbolSigns[i] == '+') ? symbolValue : -symbolValue;
-                it->updateClassIndexTableEntry(symbolTable[symbolDependencies[i] - 1].getSectionNumber(), (symbolSigns[i] == '+') ? 1 : -1);
-                it->removeSymbolDependency(i);
-                it->removeSymbolSign(i); 
+                SymbolTableEntry &dependency = symbolTable[symbolDependencies[j] - 1];
+                equSymbolValue += (symbolSigns[j] == '+') ? dependency.getSymbolValue() : -dependency.getSymbolValue();
+                equSymbol.updateClassIndexTableEntry(dependency.getSectionNumber(), (symbolSigns[j] == '+') ? 1 : -1);
             }
+            else
+            {
+                pending[i]++;
+                dependents[position].push_back(EquDependentStruct(i, symbolSigns[j]));
+            }
+        }
+        symbol.setSymbolValue(equSymbolValue);
+        if (pending[i] == 0)
+            resolved.push_back(i);
+    }
+    for (unsigned int next = 0; next < resolved.size(); next++)
+    {
+        EquTableEntry &equSymbol = equSymbolTable[resolved[next]];
+        SymbolTableEntry &symbol = symbolTable[equSymbol.getSymbolNumber() - 1];
+        if (equSymbol.isExpressionValid() == false)
+        {
+            diagnostics.error("Equ expression is invalid!");
+            return;
         }
-        if (it->getSymbolDependencies().size() == 0)
-        { 
-           if (it->isExpressionValid() == false) {
-               std::cout << "Equ expression is invalid!\n";
-               return;
-           }
-           else {
-               if (it->entryNotZero() == 0)
-                symbolTable[it->getSymbolNumber() - 1].setSymbolScopeToExtern();
-               symbolTable[it->getSymbolNumber() - 1].setDefinedToTrue();
-           }
-           
+        equSymbol.setResolved();
+        if (equSymbol.getEntryNot0() == 0)
+            symbol.setSymbolScopeToExtern();
+        symbol.setDefinedToTrue();
+        for (EquDependentStruct &dependent : dependents[resolved[next]])
+        {
+            SymbolTableEntry &dependentSymbol = symbolTable[equSymbolTable[dependent.equPosition].getSymbolNumber() - 1];
+            dependentSymbol.setSymbolValue(dependentSymbol.getSymbolValue() + ((dependent.sign == '+') ? symbol.getSymbolValue() : -symbol.getSymbolValue()));
+            if (equSymbol.getEntryNot0() != -1)
+                equSymbolTable[dependent.equPosition].updateClassIndexTableEntry(equSymbol.getEntryNot0(), (dependent.sign == '+') ? 1 : -1);
+            if (--pending[dependent.equPosition] == 0)
+                resolved.push_back(dependent.equPosition);
         }
-        symbolTable[it->getSymbolNumber() - 1].setSymbolValue(equSymbolValue);
+    }
+    if (resolved.size() < count)
+    { // Whatever is left is either within a cycle, or depends on one
+        std::vector<bool> reported(count, false);
+        for (unsigned int i = 0; i < count; i++)
+            if (pending[i] > 0 && reported[i] == false)
+            {
+                std::string cycle = describeEquCycle(i, pending, reported);
+                if (cycle.empty() == false)
+                    diagnostics.error("Circular EQU definition: " + cycle + "!");
+            }
+        diagnostics.error("Equ expression(s) is(are) invalid!");
     }
 }
 
-int getEntryNot0(unsigned int equSymbolNumber)
+void Assembler::processEquForwardReferences()
 {
-    auto it = equSymbolTable.begin();
-    for (; it != equSymbolTable.end(); it++)
-        if (it->getSymbolNumber() == equSymbolNumber)
-            return it->entryNotZero();
-    return -1; // Unreachable code
-}
-
-void processEquValue2()
-{ // Updating EQU symbol values, based off of EQU symbols... At this point at least one EQU symbol must be defined, otherwise we have circular dependency
-// In one iteration, at least one EQU symbol must get defined, up until all EQU symbols are defined
-    int numOfUndefinedEquSymbols = 0;
-    auto iter = equSymbolTable.begin();
-    for (; iter != equSymbolTable.end(); iter++)
-        if (symbolTable[iter->getSymbolNumber() - 1].getDefined() == false)
-            numOfUndefinedEquSymbols++;
-    bool keepGoing = true;
-    while (keepGoing == true)
+    patchForwardReferences(true);
+    for (Section &section : sections)
     {
-        keepGoing = false;
-        auto it = equSymbolTable.begin();
-        for (; it != equSymbolTable.end(); it++)
+        std::vector<RelocationTableEntry> &relocationTable = section.getRelocationTable();
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < relocationTable.size(); i++)
         {
-            if (symbolTable[it->getSymbolNumber() - 1].getDefined() == false) {
-                std::vector<unsigned int> symbolDependencies = it->getSymbolDependencies();
-                std::vector<char> symbolSigns = it->getSymbolSigns();
-                int equSymbolValue = symbolTable[it->getSymbolNumber() - 1].getSymbolValue();
-                for (int i = 0; i < symbolDependencies.size(); i++)
-                    if (symbolTable[symbolDependencies[i] - 1].getDefined() == true) {
-                        int symbolValue = symbolTable[symbolDependencies[i] - 1].getSymbolValue();
-                        equSymbolValue += (symbolSigns[i] == '+') ? symbolValue : -symbolValue;
-                        int entryNot0 = getEntryNot0(symbolDependencies[i]);
-                        if (entryNot0 != -1) 
-                            it->updateClassIndexTableEntry(entryNot0, (symbolSigns[i] == '+') ? 1 : -1);
-                        it->removeSymbolDependency(i);
-                        it->removeSymbolSign(i);
-                    }
-                if (it->getSymbolDependencies().size() == 0) {
-                    if (it->isExpressionValid() == true)
-                    {
-                        if (it->entryNotZero() == 0)
-                            symbolTable[it->getSymbolNumber() - 1].setSymbolScopeToExtern();
-                        symbolTable[it->getSymbolNumber() - 1].setSymbolValue(equSymbolValue);
-                        symbolTable[it->getSymbolNumber() - 1].setDefinedToTrue();
-                        keepGoing = true;
-                        numOfUndefinedEquSymbols--;
-                    }
-                    else {
-                        std::cout << "Equ expression is invalid!\n";
-                        return;
-                    }
+            RelocationTableEntry &relocation = relocationTable[i];
+            if (symbolTable[relocation.getSymbolNumber() - 1].getEqu() == true)
+            {
+                int entryNot0 = equSymbolTable[equSymbolIndex[relocation.getSymbolNumber()]].getEntryNot0();
+                if (entryNot0 == -1) continue;
+                if (entryNot0 != 0)
+                {
+                    if (relocation.getType() == RelocationTableEntry::RELATIVE && section.getSectionNumber() == (unsigned int)entryNot0)
+                        continue; // No relocation data is needed
+                    relocation.setSymbolNumber(entryNot0);
                 }
-                else
-                    symbolTable[it->getSymbolNumber() - 1].setSymbolValue(equSymbolValue);
             }
+            relocationTable[kept++] = relocation;
         }
-    }
-    if (numOfUndefinedEquSymbols > 0) {
-        std::cout << "Equ expression(s) is(are) invalid!\n";
-        return;
+        relocationTable.erase(relocationTable.begin() + kept, relocationTable.end());
     }
 }
 
-void processEquForwardReferences()
+// Text dump of the symbol table, the sections' contents and the relocation data
+// Default layout has one "offset : byte" line for each byte; dense layout has 16 bytes per line, prefixed with the offset of the first one
+bool Assembler::writeTextOutput(const char *path, bool denseLayout)
 {
-    auto it = symbolTable.begin();
-    for (; it != symbolTable.end(); it++)
+    startPhase();
+    TextOutputBuffer outputFile;
+    if (outputFile.open(path) == false)
+        return false;
+    outputFile.append("Symbol Table:\n");
+    outputFile.append("Symbol Number\tSymbol Name\tSection Number\tSymbol Value\tSymbol Scope\n");
+    auto symbolTableIterator = symbolTable.begin();
+    for (; symbolTableIterator != symbolTable.end(); symbolTableIterator++)
     {
-        if (it->getEqu() == false) continue;
-        std::list<ForwardReferenceStruct> forwardReferences = it->getFowardsReferences();
-        auto iter = forwardReferences.begin();
-        for (; iter != forwardReferences.end(); iter++)
-        {
-            char lowerByte = (char)(outputFileData[iter->sectionNumber][iter->patch] & 0xFF);
-            char higherByte = (char)(outputFileData[iter->sectionNumber][iter->patch + 1] & 0xFF);
-            int dataValue = lowerByte | (higherByte << 8);
-            int symbolValue = it->getSymbolValue();
-            dataValue += (iter->sign == '+') ? symbolValue : -symbolValue;
-            // Get the new value back in the file
-            outputFileData[iter->sectionNumber][iter->patch] = (char)(dataValue & 0xFF);
-            outputFileData[iter->sectionNumber][iter->patch + 1] = (char)((dataValue >> 8) & 0xFF);
-        }
-        // Update all of the relocation data for the symbol
-        auto iterator = sectionRelocationTables.begin();
-        for (; iterator != sectionRelocationTables.end(); iterator++)
+        outputFile.appendDecimal(symbolTableIterator->getNumber());
+        outputFile.append('\t');
+        outputFile.append(symbolNames.getName(symbolTableIterator->getNameId()));
+        outputFile.append('\t');
+        outputFile.appendDecimal(symbolTableIterator->getSectionNumber());
+        outputFile.append('\t');
+        outputFile.appendDecimal(symbolTableIterator->getSymbolValue());
+        outputFile.append('\t');
+        if (symbolTableIterator->getSymbolScope() == SymbolTableEntry::LOCAL)
+            outputFile.append("LOCAL\n\n");
+        else
+            outputFile.append("GLOBAL\n\n");
+    }
+    for (Section &section : sections)
+    {
+        if (section.getSize() == 0) continue; // Nothing has been emitted into the section
+        std::string_view sectionName = symbolNames.getName(symbolTable[section.getSectionNumber() - 1].getNameId());
+        outputFile.append(sectionName);
+        outputFile.append(":\n");
+        unsigned int size = section.getSize();
+        unsigned char bytes[TEXT_DUMP_WINDOW]; // Contents are expanded (fill runs included) one window at a time
+        for (unsigned int windowStart = 0; windowStart < size; windowStart += TEXT_DUMP_WINDOW)
         {
-            for (int i = 0; i < iterator->second.size(); i++)
+            unsigned int windowEnd = std::min(size, windowStart + TEXT_DUMP_WINDOW);
+            section.read(windowStart, windowEnd - windowStart, bytes);
+            if (denseLayout == true)
             {
-                if (iterator->second[i].getSymbolNumber() != it->getNumber()) continue;
-                int num = it->getNumber();
-                // Relocation data is for the current symbol
-                int entryNot0 = getEntryNot0(it->getNumber());
-                if (entryNot0 != -1) {
-                    if (entryNot0 != 0)
-                    {
-                        if (iterator->second[i].getType() == RelocationTableEntry::ABSOLUTE)
-                            iterator->second[i].setSymbolNumber(entryNot0); // Relocation data 
-                        else 
-                        { // PC relative relocation data
-                            if (iterator->first == entryNot0) 
-                            { // No relocation data is needed
-                                iterator->second.erase(iterator->second.begin() + i);
-                                i--;
-                            }
-                            else
-                                iterator->second[i].setSymbolNumber(entryNot0);
+                for (unsigned int i = windowStart; i < windowEnd; i += 16)
+                {
+                    for (int shift = 24; shift >= 0; shift -= 8)
+                        outputFile.appendHexByte((i >> shift) & 0xFF);
+                    outputFile.append(": ");
+                    if (windowEnd - i >= 16)
+                        outputFile.appendHexRow(bytes + (i - windowStart));
+                    else
+                        for (unsigned int j = i; j < windowEnd; j++)
+                        {
+                            if (j != i) outputFile.append(' ');
+                            outputFile.appendHexByte(bytes[j - windowStart]);
                         }
-                    }
+                    outputFile.append('\n');
                 }
-                else {
-                    iterator->second.erase(iterator->second.begin() + i);
-                    i--;
+            }
+            else
+            {
+                for (unsigned int i = windowStart; i < windowEnd; i++)
+                {
+                    outputFile.appendDecimal(i);
+                    outputFile.append(" : ");
+                    outputFile.appendHexByte(bytes[i - windowStart]);
+                    outputFile.append('\n');
                 }
             }
         }
-        it->resetForwardRefernces();
+        outputFile.append('\n');
+        if (section.getRelocationTable().size() > 0)
+        {
+            outputFile.append(sectionName);
+            outputFile.append("'s Relocation Data:\n");
+            outputFile.append("Offset\tType\tSymbol Number\n");
+            for (RelocationTableEntry &entry : section.getRelocationTable())
+            {
+                outputFile.appendHex(entry.getOffset());
+                if (entry.getType() == RelocationTableEntry::ABSOLUTE)
+                    outputFile.append("\tR_386_32\t");
+                else
+                    outputFile.append("\tR_386_PC32\t");
+                outputFile.appendDecimal(entry.getSymbolNumber());
+                outputFile.append('\n');
+            }
+            outputFile.append('\n');
+        }
     }
+    bool closed = outputFile.close();
+    endPhase("output");
+    return closed;
 }
 
-int main()
+bool Assembler::writeBinaryOutput(const char *path)
 {
-    std::ifstream assemblyFile;
-    assemblyFile.open("/home/student/Desktop/asm_program.txt");
-    bool isOpen = assemblyFile.is_open();
-    std::string line;
-    while (getline(assemblyFile, line))
+    startPhase();
+    ObjectFileWriter writer;
+    ObjectFileHeader header = {};
+    std::copy(OBJECT_FILE_MAGIC, OBJECT_FILE_MAGIC + 4, header.magic);
+    header.version = OBJECT_FILE_VERSION;
+    header.headerSize = sizeof(ObjectFileHeader);
+    writer.add(&header, sizeof(ObjectFileHeader));
+    // Symbol table
+    std::vector<ObjectSymbol> symbols(symbolTable.size());
+    unsigned int relocationCount = 0;
+    for (unsigned int i = 0; i < symbolTable.size(); i++)
     {
-        processLine(line);
+        SymbolTableEntry &entry = symbolTable[i];
+        symbols[i].nameOffset = symbolNames.getOffset(entry.getNameId());
+        symbols[i].nameLength = symbolNames.getName(entry.getNameId()).size();
+        symbols[i].sectionNumber = entry.getSectionNumber();
+        symbols[i].value = entry.getSymbolValue();
+        symbols[i].scope = entry.getSymbolScope();
+        symbols[i].flags = (entry.getDefined() ? ObjectSymbol::DEFINED : 0) | (entry.getEqu() ? ObjectSymbol::EQU : 0);
     }
-    processNonEquForwardReferences();
-    processEquValue1();
-    processEquValue2();
-    processEquForwardReferences();
-    assemblyFile.close();
-    std::ofstream outputFile;
-    outputFile.open("/home/student/Desktop/output_file.txt");
-    outputFile << "Symbol Table:\n";
-    outputFile << "Symbol Number\tSymbol Name\tSection Number\tSymbol Value\tSymbol Scope\n";
-    auto symbolTableIterator = symbolTable.begin();
-    for (; symbolTableIterator != symbolTable.end(); symbolTableIterator++)
+    header.symbolCount = symbols.size();
+    header.symbolTableOffset = writer.add(symbols.data(), symbols.size() * sizeof(ObjectSymbol));
+    // Section table - filled in below, the writer only keeps a pointer to it
+    std::vector<ObjectSection> sectionRecords(sections.size());
+    header.sectionCount = sectionRecords.size();
+    header.sectionTableOffset = writer.add(sectionRecords.data(), sectionRecords.size() * sizeof(ObjectSection));
+    // String table
+    std::string_view names = symbolNames.getContents();
+    header.stringTableSize = names.size();
+    header.stringTableOffset = writer.add(names.data(), names.size());
+    // Section data
+    for (unsigned int i = 0; i < sections.size(); i++)
     {
-        outputFile << symbolTableIterator->getNumber() << "\t" << symbolTableIterator->getSymbolName() << "\t"
-            << symbolTableIterator->getSectionNumber() << "\t" << symbolTableIterator->getSymbolValue() << "\t";
-        if (symbolTableIterator->getSymbolScope() == SymbolTableEntry::LOCAL)
-            outputFile << "LOCAL\n\n";
+        sectionRecords[i].symbolNumber = sections[i].getSectionNumber();
+        sectionRecords[i].size = sections[i].getSize();
+        sectionRecords[i].dataOffset = writer.add(sections[i].getData().data(), sections[i].getData().size());
+        sectionRecords[i].dataSize = sections[i].getData().size();
+        relocationCount += sections[i].getRelocationTable().size();
+    }
+    // Relocation records, grouped by section
+    std::vector<ObjectRelocation> relocations;
+    relocations.reserve(relocationCount);
+    uint32_t relocationTableOffset = writer.getSize();
+    for (unsigned int i = 0; i < sections.size(); i++)
+    {
+        sectionRecords[i].relocationOffset = relocationTableOffset + relocations.size() * sizeof(ObjectRelocation);
+        for (RelocationTableEntry &entry : sections[i].getRelocationTable())
+        {
+            ObjectRelocation relocation = {};
+            relocation.offset = entry.getOffset();
+            relocation.symbolNumber = entry.getSymbolNumber();
+            relocation.type = entry.getType();
+            relocations.push_back(relocation);
+        }
+        sectionRecords[i].relocationCount = sections[i].getRelocationTable().size();
+    }
+    writer.add(relocations.data(), relocations.size() * sizeof(ObjectRelocation));
+    // Fill runs, grouped by section - only their sizes are written, never their bytes
+    std::vector<ObjectFill> fills;
+    uint32_t fillTableOffset = writer.getSize();
+    for (unsigned int i = 0; i < sections.size(); i++)
+    {
+        sectionRecords[i].fillOffset = fillTableOffset + fills.size() * sizeof(ObjectFill);
+        for (const Section::FillRun &run : sections[i].getFillRuns())
+        {
+            ObjectFill fill = {};
+            fill.offset = run.offset;
+            fill.count = run.count;
+            fill.value = run.value;
+            fill.size = run.size;
+            fills.push_back(fill);
+        }
+        sectionRecords[i].fillCount = sections[i].getFillRuns().size();
+    }
+    writer.add(fills.data(), fills.size() * sizeof(ObjectFill));
+    bool written = writer.write(path);
+    endPhase("output");
+    return written;
+}
+
+// Text as a JSON string literal
+std::string jsonString(std::string_view text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if ((unsigned char)c < 0x20)
+        {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
         else
-            outputFile << "GLOBAL\n\n";
+            quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void writeStatsJson(std::ostream &stream, const Assembler::StatsStruct &stats)
+{
+    static const char *LINE_KINDS[] = { "none", "label", "global", "extern", "section", "byte", "word", "skip", "fill", "equ", "noaddr", "branch", "oneaddr", "twoaddr" };
+    stream << "\"lines\":{";
+    for (unsigned int kind = 0; kind <= LineRecord::TWOADDR_INSTRUCTION; kind++)
+        stream << ((kind > 0) ? "," : "") << "\"" << LINE_KINDS[kind] << "\":" << stats.lines[kind];
+    stream << "},\"lexer_runs\":" << stats.lexerRuns << ",\"regex_searches\":" << stats.regexSearches
+        << ",\"symbol_lookups\":" << stats.symbolLookups << ",\"symbol_lookup_probes\":" << stats.symbolLookupProbes
+        << ",\"forward_references_patched\":" << stats.patchedForwardReferences << ",\"relocations_added\":" << stats.addedRelocations
+        << ",\"relocations_erased\":" << stats.erasedRelocations << ",\"bytes_emitted\":" << stats.emittedBytes
+        << ",\"pipeline_stall_seconds\":{\"reader\":" << stats.readerStallSeconds << ",\"parser\":" << stats.parserStallSeconds
+        << ",\"processing\":" << stats.processingStallSeconds << "}";
+}
+
+// {"input": ..., "phases": [{"name": ..., "wall_seconds": ..., "cpu_seconds": ..., "process_peak_rss_kib": ..., counters}, ...], "total": {counters},
+// "sections": [{"name": ..., "bytes": ..., "relocations": ...}, ...]}
+void Assembler::writeStatsJson(std::ostream &stream, const std::string &inputPath)
+{
+    stream << "{\"input\":" << jsonString(inputPath) << ",\"phases\":[";
+    for (unsigned int i = 0; i < phases.size(); i++)
+    {
+        stream << ((i > 0) ? "," : "") << "{\"name\":\"" << phases[i].name << "\",\"wall_seconds\":" << phases[i].seconds
+            << ",\"cpu_seconds\":" << phases[i].cpuSeconds << ",\"process_peak_rss_kib\":" << phases[i].peakMemory << ",";
+        ::writeStatsJson(stream, phases[i].stats);
+        stream << "}";
+    }
+    stream << "],\"total\":{";
+    ::writeStatsJson(stream, getStats());
+    stream << "},\"sections\":[";
+    for (unsigned int i = 0; i < sections.size(); i++)
+    {
+        Section &section = sections[i];
+        stream << ((i > 0) ? "," : "") << "{\"name\":" << jsonString(symbolNames.getName(symbolTable[section.getSectionNumber() - 1].getNameId()))
+            << ",\"bytes\":" << section.getSize() << ",\"relocations\":" << section.getRelocationTable().size() << "}";
+    }
+    stream << "]}\n";
+}
+
+#ifndef ASSEMBLER_NO_MAIN // Defined by the tools which include this file to drive the Assembler themselves (e.g. bench/benchmark.cpp)
+
+// Output file of an input file in batch mode: the input's extension is replaced with .o (binary object file) or .txt (text dump)
+std::string outputPathFor(const std::string &inputPath, bool binaryOutput)
+{
+    size_t nameStart = inputPath.find_last_of('/');
+    size_t extensionStart = inputPath.find_last_of('.');
+    std::string stem = inputPath;
+    if (extensionStart != std::string::npos && (nameStart == std::string::npos || extensionStart > nameStart + 1))
+        stem = inputPath.substr(0, extensionStart);
+    std::string outputPath = stem + (binaryOutput ? ".o" : ".txt");
+    if (outputPath == inputPath) // Never overwrite the input itself
+        outputPath = inputPath + (binaryOutput ? ".o" : ".txt");
+    return outputPath;
+}
+
+// Assembles one input and writes out its output; any failure is reported on messages
+// With a cache, an input which was already assembled (same contents, same output options) is not assembled again - its output is copied
+// Validating the lexer always assembles (and the output is not cached), since the point is to see the warnings, which are not cached
+// With a stats stream, the metrics of the assembly are written to it as one line of JSON
+bool assembleFile(Assembler &assembler, const std::string &inputPath, const std::string &outputPath, bool binaryOutput, bool denseLayout,
+    ObjectCache *cache, std::ostream &messages, std::ostream *stats)
+{
+    std::string cacheKey;
+    if (cache != nullptr && assembler.getValidateLexer() == false)
+    {
+        SourceFile input;
+        if (input.open(inputPath.c_str()) == true)
+        {
+            cacheKey = ObjectCache::makeKey(input.getContents(), (binaryOutput == true) ? "binary" : ((denseLayout == true) ? "text dense" : "text"));
+            if (cache->fetch(cacheKey, outputPath.c_str()) == true)
+            {
+                if (stats != nullptr)
+                    *stats << "{\"input\":" << jsonString(inputPath) << ",\"cached\":true}\n";
+                return true;
+            }
+        }
+    }
+    if (assembler.assemble(inputPath.c_str()) == false)
+    {
+        messages << "Unable to open the input file " << inputPath << "!\n";
+        return false;
+    }
+    bool written = (binaryOutput == true) ? assembler.writeBinaryOutput(outputPath.c_str()) : assembler.writeTextOutput(outputPath.c_str(), denseLayout);
+    if (written == false)
+    {
+        messages << "Unable to write the output file " << outputPath << "!\n";
+        return false;
     }
-    auto outputFileIterator = outputFileData.begin();
-    for (; outputFileIterator != outputFileData.end(); outputFileIterator++)
+    if (stats != nullptr)
+        assembler.writeStatsJson(*stats, inputPath);
+    if (assembler.getErrorCount() > 0)
+        return false; // Output is still written (as far as it got), but it is not cached
+    if (cacheKey.empty() == false)
+        cache->store(cacheKey, outputPath.c_str());
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    bool binaryOutput = false; // Binary object file instead of the text dump
+    bool denseLayout = false; // Text dump with 16 bytes per line
+    bool validateLexer = false;
+    bool trace = false; // Every line being processed is described on the standard output
+    unsigned int jobs = 1; // Number of inputs which are assembled at the same time
+    unsigned int parseThreads = 1; // Number of threads parsing the lines of one input
+    bool pipelined = false; // Reading, parsing and processing the lines of one input on three threads at the same time
+    bool watch = false; // Assembling the input again each time it is saved
+    std::string cacheDirectory; // Outputs are cached within this directory, if it is set
+    uint64_t cacheSizeLimit = 256; // In MiB
+    bool printCacheStats = false;
+    bool printStats = false; // Metrics of each assembly, as JSON lines on the standard error
+    std::vector<std::string> inputPaths; // Batch mode - all of the inputs are assembled within this one process, one after another
+    for (int i = 1; i < argc; i++)
     {
-        outputFile << symbolTable[outputFileIterator->first - 1].getSymbolName() << ":\n";
-        int size = outputFileIterator->second.size();
-        for (int i = 0; i < size; i++)
+        std::string argument = argv[i];
+        if (argument == "--validate-lexer")
+            validateLexer = true;
+        else if (argument == "--trace")
+        {
+#ifdef NDEBUG
+            std::cout << "Warning: --trace has no effect, trace messages are not compiled into this build!\n";
+#else
+            trace = true;
+#endif
+        }
+        else if (argument == "--binary")
+            binaryOutput = true;
+        else if (argument == "--dense")
+            denseLayout = true;
+        else if (argument == "--pipeline")
+            pipelined = true;
+        else if (argument == "--watch")
+            watch = true;
+        else if (argument == "--cache" && i + 1 < argc)
+            cacheDirectory = argv[++i];
+        else if (argument == "--cache-size" && i + 1 < argc)
+            cacheSizeLimit = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--cache-stats")
+            printCacheStats = true;
+        else if (argument == "--stats=json")
+            printStats = true;
+        else if (argument == "-j" && i + 1 < argc)
         {
-            char buffer[100];
-            sprintf(buffer, "%d : %.2X", i, (unsigned char)outputFileIterator->second[i]);
-            std::string outputFileLine = buffer;
-            outputFile << outputFileLine << "\n";
+            jobs = std::strtoul(argv[++i], nullptr, 10);
+            if (jobs == 0)
+                jobs = std::thread::hardware_concurrency();
         }
-        outputFile << "\n";
-        if (sectionRelocationTables.find(outputFileIterator->first) != sectionRelocationTables.end() &&
-            sectionRelocationTables[outputFileIterator->first].size() > 0)
+        else if (argument == "--parse-threads" && i + 1 < argc)
         {
-            outputFile << symbolTable[outputFileIterator->first - 1].getSymbolName() << "'s Relocation Data:\n";
-            outputFile << "Offset\tType\tSymbol Number\n";
-            int size = sectionRelocationTables[outputFileIterator->first].size();
-            for (int i = 0; i < size; i++)
+            parseThreads = std::strtoul(argv[++i], nullptr, 10);
+            if (parseThreads == 0)
+                parseThreads = std::thread::hardware_concurrency();
+        }
+        else if (argument == "--batch" && i + 1 < argc)
+        { // File which lists the inputs, one per line
+            SourceFile inputList;
+            if (inputList.open(argv[++i]) == false)
             {
-                char buffer[100];
-                sprintf(buffer, "%X\t", sectionRelocationTables[outputFileIterator->first][i].getOffset());
-                std::string outputFileLine = buffer;
-                if (sectionRelocationTables[outputFileIterator->first][i].getType() == RelocationTableEntry::ABSOLUTE)
-                    outputFileLine += "R_386_32\t";
-                else
-                    outputFileLine += "R_386_PC32\t";
-                outputFile << outputFileLine << sectionRelocationTables[outputFileIterator->first][i].getSymbolNumber() << "\n";
+                std::cout << "Unable to open the input list " << argv[i] << "!\n";
+                return 1;
             }
-            outputFile << "\n";
+            std::string_view inputPath;
+            while (inputList.nextLine(inputPath))
+                if (inputPath.empty() == false)
+                    inputPaths.push_back(std::string(inputPath));
+        }
+        else if (argument.size() > 1 && argument[0] == '-')
+            std::cout << "Unknown option: " << argument << "\n";
+        else
+            inputPaths.push_back(argument);
+    }
+    ObjectCache objectCache;
+    ObjectCache *cache = nullptr;
+    if (cacheDirectory.empty() == false)
+    {
+        if (objectCache.open(cacheDirectory, cacheSizeLimit << 20) == false)
+        {
+            std::cout << "Unable to open the cache directory " << cacheDirectory << "!\n";
+            return 1;
+        }
+        cache = &objectCache;
+    }
+    Diagnostics::Level messageLevel = (trace == true) ? Diagnostics::TRACE : Diagnostics::WARNING;
+    Assembler assembler;
+    assembler.setMessageLevel(messageLevel);
+    assembler.setValidateLexer(validateLexer);
+    assembler.setParseThreads(parseThreads);
+    assembler.setPipelined(pipelined);
+    if (watch == true)
+    { // The same Assembler (with its tables and cached blocks) is kept between the assemblies, so only the changed blocks are encoded again
+        if (inputPaths.size() > 1)
+        {
+            std::cout << "Only one input file can be watched!\n";
+            return 1;
+        }
+        std::string inputPath = (inputPaths.empty() == true) ? DEFAULT_INPUT_PATH : inputPaths[0];
+        std::string outputPath = (inputPaths.empty() == false) ? outputPathFor(inputPath, binaryOutput) :
+            ((binaryOutput == true) ? DEFAULT_BINARY_OUTPUT_PATH : DEFAULT_TEXT_OUTPUT_PATH);
+        FileWatcher watcher;
+        if (watcher.open(inputPath) == false)
+        {
+            std::cout << "Unable to watch the input file " << inputPath << "!\n";
+            return 1;
         }
+        assembler.setIncremental(true);
+        do
+        {
+            if (assembleFile(assembler, inputPath, outputPath, binaryOutput, denseLayout, cache, std::cout, printStats ? &std::cerr : nullptr) == true)
+                std::cout << "Assembled " << inputPath << ": " << assembler.getLineCount() << " lines, " << assembler.getEncodedLineCount() << " encoded\n";
+            std::cout.flush();
+        } while (watcher.waitForChange() == true);
+        std::cout << "Unable to watch the input file " << inputPath << "!\n";
+        return 1;
+    }
+    int status = 0;
+    if (inputPaths.empty() == true)
+    { // Single file, at the default location
+        if (assembleFile(assembler, DEFAULT_INPUT_PATH, (binaryOutput == true) ? DEFAULT_BINARY_OUTPUT_PATH : DEFAULT_TEXT_OUTPUT_PATH,
+            binaryOutput, denseLayout, cache, std::cout, printStats ? &std::cerr : nullptr) == false)
+            status = 1;
+    }
+    else
+    { // Each worker has its own Assembler (tables, name arena, output buffers); messages of each input are collected and printed all at once
+        WorkStealingPool pool(jobs);
+        std::vector<Assembler> assemblers(pool.getWorkerCount());
+        std::mutex messageMutex;
+        std::atomic<int> failed(0);
+        pool.run(inputPaths.size(), [&](unsigned int worker, unsigned int jobNumber) {
+            const std::string &inputPath = inputPaths[jobNumber];
+            Assembler &assembler = assemblers[worker];
+            std::ostringstream messages, stats;
+            assembler.setValidateLexer(validateLexer);
+            assembler.setParseThreads(parseThreads);
+            assembler.setPipelined(pipelined);
+            assembler.setMessageStream(messages);
+            assembler.setMessageLevel(messageLevel);
+            if (assembleFile(assembler, inputPath, outputPathFor(inputPath, binaryOutput), binaryOutput, denseLayout, cache, messages,
+                printStats ? &stats : nullptr) == false)
+                failed = 1;
+            std::lock_guard<std::mutex> lock(messageMutex);
+            std::cout << messages.str();
+            std::cerr << stats.str();
+        });
+        status = failed;
     }
-    outputFile.close();
-    return 0;
-}
\ No newline at end of file
+    if (cache != nullptr)
+    {
+        std::vector<uint64_t> totals = cache->updateStats();
+        if (printCacheStats == true)
+            std::cout << "Object cache: " << totals[0] << " hits, " << totals[1] << " misses, " << totals[2] << " evictions\n";
+    }
+    return status;
+}
+
+#endif